@@ -0,0 +1,92 @@
+/*
+ * CH224Q Example: Coroutine based negotiation of two CH224Q
+ *
+ * This example demonstrates the optional C++20 coroutine layer (CH224Q_Async.h).
+ * Two CH224Q on two I2C buses are negotiated at the same time from one thread:
+ * each task requests 9V, reads the capabilities, switches to a PPS voltage and verifies
+ * the current limit. While one task waits for its PSU, the other one keeps running.
+ *
+ * Needs a compiler with coroutine support (-std=c++20, e.g. build_flags = -std=gnu++20 and
+ * build_unflags = -std=gnu++17 in PlatformIO) and a board with two I2C buses (ESP32, RP2040, ...).
+ *
+ * by 4R3N(cad435) 2026-01-11
+ *
+ */
+
+#include <Arduino.h>
+#include <CH224Q_Arduino.h>
+#include <CH224Q_Registers.h>
+#include <CH224Q_PDO_Decoder.h>
+#include <CH224Q_Async.h>
+
+#ifndef CH224Q_HAS_COROUTINES
+#error "This example needs C++20 coroutine support, see comment at the top"
+#endif
+
+
+CH224Q_Scheduler scheduler;
+
+CH224Q* ch224q[2];
+CH224Q_Async* device[2];
+
+
+CH224Q_Task negotiate(CH224Q_Async& dev, uint8_t port, uint16_t pps_mV)
+{
+  if (co_await dev.setMode(CH224Q_MODE_9V) != 0)
+  {
+    Serial.printf("Port %d: 9V not accepted\n", port);
+    co_return -1;
+  }
+  Serial.printf("Port %d: 9V @ %dmA\n", port, dev.device()->getMaxCurrent_mA());
+
+  //cached PPS range of all APDOs
+  dev.device()->refreshCapabilities();
+  bool ppsAvailable = (pps_mV >= dev.device()->getPPSMinVoltage_mv() && pps_mV <= dev.device()->getPPSMaxVoltage_mv());
+  if (!ppsAvailable)
+  {
+    Serial.printf("Port %d: no PPS for %dmV, staying at 9V\n", port, pps_mV);
+    co_return 0;
+  }
+
+  if (co_await dev.requestPPS(pps_mV) != 0)
+  {
+    Serial.printf("Port %d: PPS %dmV failed\n", port, pps_mV);
+    co_return -1;
+  }
+
+  co_await scheduler.sleep_ms(500); //let the voltage settle before verifying, other port keeps running meanwhile
+
+  Serial.printf("Port %d: PPS %dmV @ %dmA, status 0x%02X\n", port, pps_mV, dev.device()->getMaxCurrent_mA(), dev.device()->getStatus());
+  co_return 0;
+}
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(115200);
+  delay(2000);
+  while (!Serial); //wait for serial
+
+  Serial.println("CH224Q Async Example");
+
+  ch224q[0] = new CH224Q(&Wire);
+  ch224q[1] = new CH224Q(&Wire1);
+
+  delay(500); //wait for charger to setup everything
+
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (ch224q[i]->begin() != 0)
+      Serial.printf("CH224Q %d initialisation failed!\n", i);
+    device[i] = new CH224Q_Async(ch224q[i], &scheduler);
+  }
+
+  scheduler.spawn(negotiate(*device[0], 0, 9000));
+  scheduler.spawn(negotiate(*device[1], 1, 12000));
+}
+
+void loop() {
+
+  scheduler.poll(); //resumes the negotiation tasks, anything else can run here as well
+
+}
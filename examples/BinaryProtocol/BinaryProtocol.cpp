@@ -0,0 +1,47 @@
+/*
+ * CH224Q Example: Binary command/telemetry protocol
+ *
+ * This example turns the MCU into a test fixture controlled from a host PC.
+ * Instead of printing human-readable strings, the MCU answers framed binary
+ * commands (capabilities, status, current limit, set mode/PPS/AVS, telemetry stream)
+ * on the serial port.
+ *
+ * Use the Linux controller in extras/host/ch224q_ctl.cpp to talk to it, e.g.:
+ *   ./ch224q_ctl /dev/ttyUSB0 caps
+ *   ./ch224q_ctl /dev/ttyUSB0 pps 9000
+ *
+ * Don't print anything else on the same serial port. The host skips stray text
+ * (e.g. library error messages) by resyncing on the start byte and CRC, but it costs time.
+ *
+ * by 4R3N(cad435) 2026-01-11
+ *
+ */
+
+#include <Arduino.h>
+#include <CH224Q_Arduino.h>
+#include <CH224Q_Protocol.h>
+
+
+CH224Q* ch224q;
+CH224Q_Protocol* protocol;
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(115200);
+
+  ch224q = new CH224Q();
+
+  delay(500); //wait for charger to setup everything
+
+  //even if this fails (e.g. non-PD supply) the host can still query status and retry setMode
+  ch224q->begin();
+
+  protocol = new CH224Q_Protocol(ch224q, &Serial);
+}
+
+void loop() {
+
+  protocol->poll(); //handle incoming commands and send telemetry
+
+}
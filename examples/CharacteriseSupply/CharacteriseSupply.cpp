@@ -0,0 +1,452 @@
+/*
+ * CH224Q Example: Automated PSU characterisation benchmark
+ *
+ * This example measures how a connected power supply reacts to requests instead of
+ * relying on the fixed delays used elsewhere (1000ms in begin(), 100ms in setMode(),
+ * 3000ms between consecutive PPS requests in the LoopPPS example).
+ *
+ * The program
+ *  - walks every fixed PDO via requestMode()/confirmMode() (the two halves of setMode())
+ *  - sweeps the PPS and AVS ranges, switching into PPS/AVS mode for every voltage
+ *  - for every request measures the time until the current capability register reports the
+ *    current of the requested (A)PDO, i.e. the new contract is in place, and the time until
+ *    the register stops changing
+ *  - shortens the interval between consecutive requests until the PSU doesn't follow anymore
+ *  - counts failed requests
+ *
+ * The status register can't be used to detect the new contract, it keeps reporting the protocol
+ * of the previous one. So every request starts from a fixed PDO with a different current than
+ * the requested one. Requests without such a start PDO are skipped (reported as "# ... skipped").
+ * The register reports the contract as limited by the cable: PDOs above 3A need a 5A cable,
+ * otherwise they count as failed.
+ *
+ * CH224Q_BEGIN_SETTLE_MS is not measured: it covers the start-up of the PSU after plugging in,
+ * measuring it would need a fixture which power-cycles the supply.
+ *
+ * Every measurement is printed as one CSV row (or one JSON object per line, see OUTPUT_JSON),
+ * followed by a summary with the measured values for CH224Q_MODE_SETTLE_MS etc.
+ * Capture the serial output to a file to compare supplies or firmware versions.
+ *
+ * !!ATTENTION!! The interval test intentionally provokes the PSU until it fails.
+ * Some supplies need to be unplugged afterwards. Don't connect a load while running this.
+ *
+ * by 4R3N(cad435) 2026-01-11
+ *
+ */
+
+#include <Arduino.h>
+#include <CH224Q_Arduino.h>
+#include <CH224Q_Registers.h>
+#include <CH224Q_PDO_Decoder.h>
+
+
+#define OUTPUT_JSON         0     //0: CSV rows, 1: one JSON object per line
+#define TRIALS              5     //requests per fixed PDO
+#define PPS_STEP_MV         1000  //step width of the PPS/AVS sweeps
+#define POLL_TIMEOUT_MS     2000  //a request counts as failed if the new contract isn't in place within this time
+#define SETTLE_WINDOW_MS    50    //current register is considered settled if unchanged for this time
+#define RECOVERY_MS         3000  //pause between measurements so one measurement can't disturb the next
+#define INTERVAL_REPEATS    6     //consecutive requests per tested interval
+
+const uint16_t testIntervals_ms[] = {3000, 2000, 1000, 500, 250, 100, 50, 20};
+
+
+struct Measurement {
+  bool ok;
+  uint32_t contract_us;   //time until the current capability register reported the current of the requested (A)PDO
+  uint32_t settle_us;     //time of the last change of the current capability register
+  uint16_t current_mA;    //settled current capability (last value read if failed)
+};
+
+struct Summary {
+  uint16_t requests;
+  uint16_t failures;
+  uint32_t max_contract_us;
+  uint32_t max_settle_us;
+};
+
+
+CH224Q* ch224q;
+
+PDOInfo pdo[12];
+uint8_t num_pdos = 0;
+
+Summary fixedSummary = {0, 0, 0, 0};
+Summary ppsSummary = {0, 0, 0, 0};
+Summary avsSummary = {0, 0, 0, 0};
+uint16_t minSafeInterval_ms = 0; //0 if not even the longest interval worked
+
+
+//what the current capability register reports once a contract for pdo at voltage_mV is in place (50mA per LSB, 8 bits)
+uint16_t expectedCurrent_mA(const PDOInfo &p, uint32_t voltage_mV)
+{
+  uint32_t current_mA = p.max_current_mA;
+  if (p.type == Augmented && p.apdo_type == APDO_EPR_AVS)
+  {
+    current_mA = p.max_power_mW * 1000 / voltage_mV; //EPR AVS only specifies the power, current is limited to 5A
+    if (current_mA > 5000)
+      current_mA = 5000;
+  }
+  else if (p.type == Augmented && p.apdo_type == APDO_SPR_AVS && voltage_mV > 15000)
+    current_mA = (p.raw & 0x3FF) * 10; //SPR AVS has a second current for 15V to 20V
+
+  if (current_mA > 255 * 50)
+    current_mA = 255 * 50;
+  return current_mA / 50 * 50;
+}
+
+//maps the voltage of a fixed PDO to the matching CH224Q mode, CH224Q_MODE_UNKNOWN if there is none
+int8_t modeForVoltage(uint32_t voltage_mV)
+{
+  switch (voltage_mV)
+  {
+    case 5000:  return CH224Q_MODE_5V;
+    case 9000:  return CH224Q_MODE_9V;
+    case 12000: return CH224Q_MODE_12V;
+    case 15000: return CH224Q_MODE_15V;
+    case 20000: return CH224Q_MODE_20V;
+    case 28000: return CH224Q_MODE_28V;
+    default:    return CH224Q_MODE_UNKNOWN;
+  }
+}
+
+//a fixed PDO to start a measurement from, its current has to differ from the one of the requested (A)PDO. -1 if there is none
+int8_t findStartPDO(uint16_t target_mA)
+{
+  for (uint8_t i = 0; i < num_pdos; i++)
+  {
+    if (pdo[i].type == Fixed && modeForVoltage(pdo[i].min_voltage_mV) != CH224Q_MODE_UNKNOWN &&
+        expectedCurrent_mA(pdo[i], pdo[i].min_voltage_mV) != target_mA)
+      return i;
+  }
+  return -1;
+}
+
+void printSkipped(const char* kind, uint32_t target_mV)
+{
+  Serial.print("# ");
+  Serial.print(kind);
+  Serial.print(' ');
+  Serial.print(target_mV);
+  Serial.println("mV skipped, no fixed PDO with a different current to start from");
+}
+
+//polls the current capability register as fast as the I2C bus allows until it reported expected_mA for SETTLE_WINDOW_MS
+Measurement measure(uint32_t start_us, uint16_t expected_mA)
+{
+  Measurement m = {false, 0, 0, 0};
+  bool reached = false;
+  uint16_t lastCurrent = ch224q->getMaxCurrent_mA(); //still the current of the start PDO
+  uint32_t lastChange_us = start_us;
+
+  while ((micros() - start_us) < (uint32_t)POLL_TIMEOUT_MS * 1000)
+  {
+    uint32_t now = micros();
+
+    uint16_t current = ch224q->getMaxCurrent_mA();
+    if (current != lastCurrent)
+    {
+      lastCurrent = current;
+      lastChange_us = now;
+    }
+
+    if (!reached && current == expected_mA)
+    {
+      reached = true;
+      m.contract_us = now - start_us;
+    }
+
+    if (reached && current == expected_mA && (now - lastChange_us) >= (uint32_t)SETTLE_WINDOW_MS * 1000)
+    {
+      m.ok = true;
+      m.settle_us = lastChange_us - start_us;
+      break;
+    }
+  }
+  m.current_mA = lastCurrent;
+  return m;
+}
+
+void addToSummary(Summary &s, const Measurement &m)
+{
+  s.requests++;
+  if (!m.ok)
+  {
+    s.failures++;
+    return;
+  }
+  if (m.contract_us > s.max_contract_us) s.max_contract_us = m.contract_us;
+  if (m.settle_us > s.max_settle_us) s.max_settle_us = m.settle_us;
+}
+
+void printRow(const char* kind, uint32_t target_mV, uint16_t trial, const Measurement &m)
+{
+#if OUTPUT_JSON
+  Serial.print("{\"kind\":\"");         Serial.print(kind);
+  Serial.print("\",\"target_mV\":");    Serial.print(target_mV);
+  Serial.print(",\"trial\":");          Serial.print(trial);
+  Serial.print(",\"ok\":");             Serial.print(m.ok ? "true" : "false");
+  Serial.print(",\"contract_us\":");    Serial.print(m.contract_us);
+  Serial.print(",\"settle_us\":");      Serial.print(m.settle_us);
+  Serial.print(",\"current_mA\":");     Serial.print(m.current_mA);
+  Serial.println("}");
+#else
+  Serial.print(kind);           Serial.print(',');
+  Serial.print(target_mV);      Serial.print(',');
+  Serial.print(trial);          Serial.print(',');
+  Serial.print(m.ok ? 1 : 0);   Serial.print(',');
+  Serial.print(m.contract_us);  Serial.print(',');
+  Serial.print(m.settle_us);    Serial.print(',');
+  Serial.println(m.current_mA);
+#endif
+}
+
+void printSummary(const char* kind, const Summary &s)
+{
+#if OUTPUT_JSON
+  Serial.print("{\"summary\":\"");          Serial.print(kind);
+  Serial.print("\",\"requests\":");         Serial.print(s.requests);
+  Serial.print(",\"failures\":");           Serial.print(s.failures);
+  Serial.print(",\"max_contract_us\":");    Serial.print(s.max_contract_us);
+  Serial.print(",\"max_settle_us\":");      Serial.print(s.max_settle_us);
+  Serial.println("}");
+#else
+  Serial.print("# summary ");       Serial.print(kind);
+  Serial.print(": requests=");      Serial.print(s.requests);
+  Serial.print(" failures=");       Serial.print(s.failures);
+  Serial.print(" max_contract_us="); Serial.print(s.max_contract_us);
+  Serial.print(" max_settle_us=");  Serial.println(s.max_settle_us);
+#endif
+}
+
+void benchmarkFixedPDOs()
+{
+  for (uint8_t i = 0; i < num_pdos; i++)
+  {
+    if (pdo[i].type != Fixed)
+      continue;
+    int8_t mode = modeForVoltage(pdo[i].min_voltage_mV);
+    if (mode == CH224Q_MODE_UNKNOWN)
+      continue;
+
+    uint16_t expected = expectedCurrent_mA(pdo[i], pdo[i].min_voltage_mV);
+    int8_t start = findStartPDO(expected);
+    if (start < 0)
+    {
+      printSkipped("fixed", pdo[i].min_voltage_mV);
+      continue;
+    }
+
+    for (uint16_t trial = 0; trial < TRIALS; trial++)
+    {
+      ch224q->setMode(modeForVoltage(pdo[start].min_voltage_mV));
+      delay(RECOVERY_MS);
+
+      uint32_t startTime = micros();
+      Measurement m = {false, 0, 0, 0};
+      if (ch224q->requestMode(mode) == 0)
+        m = measure(startTime, expected);
+      if (m.ok)
+        ch224q->confirmMode(mode); //keep the library's current mode in sync
+      else
+        ch224q->setMode(modeForVoltage(pdo[start].min_voltage_mV)); //PSU didn't follow, back to a known contract
+
+      addToSummary(fixedSummary, m);
+      printRow("fixed", pdo[i].min_voltage_mV, trial, m);
+    }
+  }
+}
+
+//true if an APDO of the same kind before index already covers voltage_mV
+bool coveredByEarlierAPDO(uint8_t index, uint32_t voltage_mV)
+{
+  for (uint8_t i = 0; i < index; i++)
+  {
+    if (pdo[i].type == Augmented && pdo[i].apdo_type == pdo[index].apdo_type &&
+        voltage_mV >= pdo[i].min_voltage_mV && voltage_mV <= pdo[i].max_voltage_mV)
+      return true;
+  }
+  return false;
+}
+
+//sweeps the range of one APDO, every voltage is requested by switching from a fixed PDO into PPS or AVS mode.
+//Voltages covered by several APDOs are only measured with the first one, assuming the CH224Q requests that one
+void benchmarkSweep(const char* kind, uint8_t index, uint32_t max_mV, bool avs, Summary &s)
+{
+  const PDOInfo &apdo = pdo[index];
+  uint16_t trial = 0;
+  for (uint32_t v = apdo.min_voltage_mV; v <= max_mV; v += PPS_STEP_MV)
+  {
+    if (coveredByEarlierAPDO(index, v))
+      continue;
+
+    uint16_t expected = expectedCurrent_mA(apdo, v);
+    int8_t start = findStartPDO(expected);
+    if (start < 0)
+    {
+      printSkipped(kind, v);
+      continue;
+    }
+
+    ch224q->setMode(modeForVoltage(pdo[start].min_voltage_mV));
+    delay(RECOVERY_MS);
+
+    uint8_t mode = avs ? CH224Q_MODE_AVS : CH224Q_MODE_PPS;
+    Measurement m = {false, 0, 0, 0};
+    if ((avs ? ch224q->writeAVSVoltage_mv(v) : ch224q->writePPSVoltage_mv(v)) == 0)
+    {
+      uint32_t startTime = micros();
+      if (ch224q->requestMode(mode) == 0)
+        m = measure(startTime, expected);
+    }
+    if (m.ok)
+      ch224q->confirmMode(mode);
+    else
+      ch224q->setMode(modeForVoltage(pdo[start].min_voltage_mV));
+
+    addToSummary(s, m);
+    printRow(kind, v, trial++, m);
+  }
+}
+
+void benchmarkPPS()
+{
+  for (uint8_t i = 0; i < num_pdos; i++)
+  {
+    if (pdo[i].type == Augmented && pdo[i].apdo_type == APDO_PPS)
+      benchmarkSweep("pps", i, pdo[i].max_voltage_mV, false, ppsSummary);
+  }
+}
+
+void benchmarkAVS()
+{
+  for (uint8_t i = 0; i < num_pdos; i++)
+  {
+    if (pdo[i].type == Augmented && pdo[i].apdo_type != APDO_PPS)
+      benchmarkSweep("avs", i, pdo[i].max_voltage_mV, true, avsSummary);
+  }
+}
+
+//alternates between two fixed PDOs with different currents with shrinking intervals until the PSU doesn't follow anymore
+void benchmarkInterval()
+{
+  int8_t a = findStartPDO(0xFFFF); //any fixed PDO with a mode
+  int8_t b = (a < 0) ? -1 : findStartPDO(expectedCurrent_mA(pdo[a], pdo[a].min_voltage_mV));
+  if (b < 0)
+  {
+    Serial.println("# interval test skipped, needs two fixed PDOs with different currents");
+    return;
+  }
+
+  ch224q->setMode(modeForVoltage(pdo[a].min_voltage_mV));
+  delay(RECOVERY_MS);
+
+  for (uint8_t i = 0; i < sizeof(testIntervals_ms) / sizeof(testIntervals_ms[0]); i++)
+  {
+    uint16_t interval = testIntervals_ms[i];
+    uint16_t failures = 0;
+
+    for (uint16_t trial = 0; trial < INTERVAL_REPEATS; trial++)
+    {
+      const PDOInfo &target = pdo[(trial % 2) ? a : b];
+      uint32_t start = micros();
+      ch224q->requestMode(modeForVoltage(target.min_voltage_mV));
+      delay(interval);
+
+      //new contract in place within the interval?
+      Measurement m = {false, 0, 0, 0};
+      m.current_mA = ch224q->getMaxCurrent_mA();
+      m.ok = (m.current_mA == expectedCurrent_mA(target, target.min_voltage_mV));
+      m.contract_us = micros() - start;
+      if (!m.ok)
+        failures++;
+      printRow("interval", interval, trial, m);
+    }
+
+    if (failures > 0)
+      break;
+    minSafeInterval_ms = interval;
+  }
+
+  //try to bring the PSU back into a defined state
+  delay(RECOVERY_MS);
+  ch224q->setMode(CH224Q_MODE_5V);
+}
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(115200);
+  delay(2000);
+  while (!Serial); //wait for serial
+
+  Serial.println("# CH224Q PSU characterisation");
+
+  ch224q = new CH224Q();
+
+  delay(500); //wait for charger to setup everything
+
+  int8_t e = ch224q->begin();
+  if (e != 0)
+  {
+    Serial.println("# CH224Q initialisation failed!");
+    Serial.println("# Is the powersupply used capable of USB-PD?");
+    while(true);
+  }
+
+  num_pdos = ch224q->getNumberPDOs();
+  for (uint8_t i = 0; i < num_pdos; i++)
+  {
+    pdo[i] = decodePDO(ch224q->getPDORawValue(i)); //Decode the Raw PDO value into a PDO Object
+    String pdoStr;
+    PDO2String(pdo[i], &pdoStr);
+    Serial.print("# ");
+    Serial.println(pdoStr);
+  }
+
+#if !OUTPUT_JSON
+  Serial.println("kind,target_mV,trial,ok,contract_us,settle_us,current_mA");
+#endif
+
+  benchmarkFixedPDOs();
+  benchmarkPPS();
+  benchmarkAVS();
+  benchmarkInterval();
+
+  printSummary("fixed", fixedSummary);
+  printSummary("pps", ppsSummary);
+  printSummary("avs", avsSummary);
+
+  //measured replacement for CH224Q_MODE_SETTLE_MS: slowest mode change rounded up to full ms plus 50% margin
+  uint16_t measured = (fixedSummary.requests - fixedSummary.failures) + (ppsSummary.requests - ppsSummary.failures) + (avsSummary.requests - avsSummary.failures);
+  uint32_t settle_us = fixedSummary.max_settle_us;
+  if (ppsSummary.max_settle_us > settle_us) settle_us = ppsSummary.max_settle_us;
+  if (avsSummary.max_settle_us > settle_us) settle_us = avsSummary.max_settle_us;
+  uint32_t settle_ms = (settle_us + 999) / 1000;
+
+  if (measured == 0)
+  {
+    Serial.println("# no successful measurement, keep the default constants");
+  }
+  else
+  {
+#if OUTPUT_JSON
+    Serial.print("{\"suggested\":{\"CH224Q_MODE_SETTLE_MS\":");
+    Serial.print(settle_ms + settle_ms / 2);
+    Serial.print(",\"min_safe_interval_ms\":");
+    Serial.print(minSafeInterval_ms);
+    Serial.println("}}");
+#else
+    Serial.print("# suggested: CH224Q_MODE_SETTLE_MS=");
+    Serial.print(settle_ms + settle_ms / 2);
+    Serial.print(" min_safe_interval_ms=");
+    Serial.println(minSafeInterval_ms);
+#endif
+  }
+
+  Serial.println("# done");
+}
+
+void loop() {
+
+}
@@ -19,8 +19,8 @@
 
 CH224Q* ch224q;
 
-uint32_t min_pps_voltage_mV = 28000; //start with max PPS voltage
-uint32_t max_pps_voltage_mV = 0; //start with min PPS voltage
+uint32_t min_pps_voltage_mV = 0;
+uint32_t max_pps_voltage_mV = 0;
 
 void setup() {
   // put your setup code here, to run once:
@@ -66,24 +66,12 @@ void setup() {
 
   //getting the minimum and maximum PPS Voltage values from the available APDOs
 
-
-  for (uint8_t i = 0; i < num_pdos; i++)
-  {
-    if (pdo[i].type == Variable || pdo[i].type == Augmented) //Variable or APDO (PPS)
-    {
-      if (pdo[i].min_voltage_mV < min_pps_voltage_mV)
-      {
-        min_pps_voltage_mV = pdo[i].min_voltage_mV;
-      }
-      if (pdo[i].max_voltage_mV > max_pps_voltage_mV)
-      {
-        max_pps_voltage_mV = pdo[i].max_voltage_mV;
-      }
-    }    
-  }  
+  ch224q->refreshCapabilities();
+  min_pps_voltage_mV = ch224q->getPPSMinVoltage_mv();
+  max_pps_voltage_mV = ch224q->getPPSMaxVoltage_mv();
 
 
-  if (min_pps_voltage_mV > max_pps_voltage_mV) //the values were not updated, thus no APDOs found
+  if (max_pps_voltage_mV == 0) //no PPS APDOs found
   {
     Serial.println("No PPS/APDO PDOs found, aborting!");
     while (true)
@@ -109,8 +97,16 @@ void loop() {
   {
     Serial.print("Request ");
     Serial.print(i);
-    Serial.println("mV PPS"); 
-    ch224q->requestPPSVoltage_mv(i); //request 18V in PPS mode
+    Serial.print("mV PPS"); 
+    uint16_t programmed_mV = 0;
+    if (ch224q->setPPSVoltage_mv(i, programmed_mV) == 0) //request voltage in PPS mode, rounded to what the CH224Q can program
+    {
+      Serial.print(", programmed ");
+      Serial.print(programmed_mV);
+      Serial.println("mV");
+    }
+    else
+      Serial.println(", failed");
     delay(3000); //wait for mode to settle. 3s seems to be a good value for consecutive requests without the power-supplys crashing
   }
   
@@ -0,0 +1,82 @@
+/*
+ * CH224Q Example: Shared power budget across two CH224Q sinks
+ *
+ * This example demonstrates the power-budget scheduler (CH224Q_PowerBudget.h).
+ * Two CH224Q on two I2C buses share one 45W upstream budget. Port 0 has the higher priority.
+ * Every 10 seconds the demands change, rebalance() then renegotiates only the ports
+ * whose contract actually has to change and prints the resulting contracts.
+ *
+ * Needs a board with two I2C buses (ESP32, RP2040, ...).
+ *
+ * by 4R3N(cad435) 2026-01-11
+ *
+ */
+
+#include <Arduino.h>
+#include <CH224Q_Arduino.h>
+#include <CH224Q_PowerBudget.h>
+
+
+#define TOTAL_BUDGET_MW 45000
+
+struct Scenario {
+  uint16_t voltage_mV[2];
+  uint16_t current_mA[2];
+};
+
+//demands of port 0 and port 1, voltage 0 = port idle
+const Scenario scenarios[] = {
+  {{20000, 12000}, {1500, 1500}}, //30W + 18W: port 1 has to stay at 5V
+  {{20000,  9000}, {1000, 1500}}, //20W + 13.5W: both fit
+  {{    0, 15000}, {   0, 2000}}, //port 0 idle, port 1 gets 30W
+  {{ 9000, 15000}, {1000, 2000}}, //port 1 unchanged, only port 0 is renegotiated
+};
+
+CH224Q* ch224q[2];
+CH224Q_PowerBudget budget(TOTAL_BUDGET_MW);
+uint8_t scenario = 0;
+
+void setup() {
+  // put your setup code here, to run once:
+
+  Serial.begin(115200);
+  delay(2000);
+  while (!Serial); //wait for serial
+
+  Serial.println("CH224Q Power Budget Example");
+
+  ch224q[0] = new CH224Q(&Wire);
+  ch224q[1] = new CH224Q(&Wire1);
+
+  delay(500); //wait for charger to setup everything
+
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    if (ch224q[i]->begin() != 0)
+      Serial.printf("CH224Q %d initialisation failed!\n", i);
+  }
+
+  budget.addPort(ch224q[0], 2); //port 0, higher priority
+  budget.addPort(ch224q[1], 1); //port 1
+}
+
+void loop() {
+
+  const Scenario &s = scenarios[scenario];
+  for (uint8_t i = 0; i < 2; i++)
+    budget.setDemand(i, s.voltage_mV[i], s.current_mA[i]);
+
+  int8_t e = budget.rebalance();
+
+  Serial.printf("Scenario %d: result %d, %d port(s) renegotiated, %lumW of %dmW allocated\n",
+                scenario, e, budget.getRenegotiations(), (unsigned long)budget.getAllocated_mW(), TOTAL_BUDGET_MW);
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    const CH224Q_PortContract* c = budget.getContract(i);
+    Serial.printf("  Port %d: %dmV @ %dmA = %lumW\n", i, c->voltage_mV, c->current_mA, (unsigned long)c->power_mW);
+  }
+
+  scenario = (scenario + 1) % (sizeof(scenarios) / sizeof(scenarios[0]));
+  delay(10000); //let the loads run with the new contracts
+
+}
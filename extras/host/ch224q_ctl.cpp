@@ -0,0 +1,378 @@
+/*
+ * ch224q_ctl.cpp - Linux command-line controller for the CH224Q binary protocol
+ *
+ * Talks to a MCU running the BinaryProtocol example (or any sketch using CH224Q_Protocol)
+ * over a serial port or pty. One command per invocation, output is one line per value
+ * so it can be parsed by scripts driving many fixtures.
+ *
+ * Build:  make (binary ends up in build/), or by hand:
+ *         g++ -std=c++11 -O2 -Wall -DCH224Q_ENABLE_FORMATTING=0 -I../../src -o ch224q_ctl ch224q_ctl.cpp ../../src/CH224Q_PDO_Decoder.cpp
+ *
+ * Usage:  ch224q_ctl [-b baud] [-t timeout_ms] [-w wait_ms] <port> <command> [args]
+ *   ping                     protocol version of the device
+ *   caps                     raw and decoded source capabilities (PDOs)
+ *   status                   protocol status bits and current mode
+ *   current                  current limit of the active contract in mA
+ *   mode <5|9|12|15|20|28|pps|avs>
+ *   pps <mV>                 request a PPS voltage
+ *   avs <mV>                 request an AVS voltage
+ *   stream <period_ms> [n]   stream n telemetry frames (default: until Ctrl-C), then stop the stream
+ *
+ * Exit code is 0 on success, 1 on a transport error (timeout, port) and 2 if the device reported an error.
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "CH224Q_Registers.h"
+#include "CH224Q_Protocol_Defs.h"
+#include "CH224Q_PDO_Decoder.h"
+
+
+struct Frame {
+    uint8_t cmd;
+    uint8_t len;
+    uint8_t payload[CH224Q_PROTO_MAX_PAYLOAD];
+};
+
+static int fd = -1;
+static int timeout_ms = 2000; //setMode() alone takes >100ms on the device, give it plenty of headroom
+static volatile sig_atomic_t interrupted = 0; //Ctrl-C during "stream", the stream is stopped before exiting
+
+
+static uint64_t now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + ts.tv_nsec / 1000000u;
+}
+
+static speed_t baudToSpeed(long baud)
+{
+    switch (baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        default:      return B0;
+    }
+}
+
+static int openPort(const char* path, long baud)
+{
+    fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        fprintf(stderr, "error: can't open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        fprintf(stderr, "error: %s is not a tty\n", path);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+
+    speed_t speed = baudToSpeed(baud);
+    if (speed == B0) {
+        fprintf(stderr, "error: unsupported baudrate %ld\n", baud);
+        return -1;
+    }
+    cfsetispeed(&tio, speed); //ignored on a pty
+    cfsetospeed(&tio, speed);
+
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        fprintf(stderr, "error: can't configure %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    tcflush(fd, TCIOFLUSH);
+    return 0;
+}
+
+static int sendFrame(uint8_t cmd, const uint8_t* payload, uint8_t len)
+{
+    uint8_t buf[CH224Q_PROTO_MAX_PAYLOAD + CH224Q_PROTO_FRAME_OVERHEAD];
+    uint8_t crc = CH224Q_crc8(0, len);
+    crc = CH224Q_crc8(crc, cmd);
+
+    buf[0] = CH224Q_PROTO_SOF;
+    buf[1] = len;
+    buf[2] = cmd;
+    for (uint8_t i = 0; i < len; i++) {
+        buf[3 + i] = payload[i];
+        crc = CH224Q_crc8(crc, payload[i]);
+    }
+    buf[3 + len] = crc;
+
+    size_t total = len + CH224Q_PROTO_FRAME_OVERHEAD;
+    if (write(fd, buf, total) != (ssize_t)total) {
+        fprintf(stderr, "error: write failed: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+//reads the next valid frame, bytes outside of frames and frames with a bad CRC are skipped
+static int readFrame(Frame* f, int timeout)
+{
+    enum { WAIT_SOF, LEN, CMD, PAYLOAD, CRC } state = WAIT_SOF;
+    uint8_t crc = 0;
+    uint8_t pos = 0;
+    uint64_t deadline = now_ms() + timeout;
+
+    while (true) {
+        int64_t left = (int64_t)(deadline - now_ms());
+        if (left <= 0 || interrupted)
+            return -1;
+
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, (int)left) <= 0)
+            continue;
+
+        uint8_t b;
+        if (read(fd, &b, 1) != 1)
+            continue;
+
+        switch (state) {
+            case WAIT_SOF:
+                if (b == CH224Q_PROTO_SOF)
+                    state = LEN;
+                break;
+            case LEN:
+                if (b > CH224Q_PROTO_MAX_PAYLOAD) { state = WAIT_SOF; break; }
+                f->len = b;
+                crc = CH224Q_crc8(0, b);
+                state = CMD;
+                break;
+            case CMD:
+                f->cmd = b;
+                crc = CH224Q_crc8(crc, b);
+                pos = 0;
+                state = (f->len > 0) ? PAYLOAD : CRC;
+                break;
+            case PAYLOAD:
+                f->payload[pos++] = b;
+                crc = CH224Q_crc8(crc, b);
+                if (pos >= f->len)
+                    state = CRC;
+                break;
+            case CRC:
+                if (b == crc)
+                    return 0;
+                state = WAIT_SOF;
+                break;
+        }
+    }
+}
+
+//sends a command and waits for its reply, telemetry frames in between are dropped
+static int transact(uint8_t cmd, const uint8_t* payload, uint8_t len, Frame* reply)
+{
+    if (sendFrame(cmd, payload, len) != 0)
+        return 1;
+
+    uint64_t deadline = now_ms() + timeout_ms;
+    while (true) {
+        int64_t left = (int64_t)(deadline - now_ms());
+        if (left <= 0 || readFrame(reply, (int)left) != 0) {
+            fprintf(stderr, "error: no reply to command 0x%02X\n", cmd);
+            return 1;
+        }
+        if (reply->cmd == (cmd | CH224Q_PROTO_REPLY) && reply->len >= 1)
+            break;
+    }
+
+    int8_t result = (int8_t)reply->payload[0];
+    if (result != 0) {
+        printf("result=%d\n", result);
+        return 2;
+    }
+    return 0;
+}
+
+static void onSigint(int)
+{
+    interrupted = 1;
+}
+
+static uint16_t getU16(const uint8_t* b) { return (uint16_t)b[0] | ((uint16_t)b[1] << 8); }
+static uint32_t getU32(const uint8_t* b) { return (uint32_t)getU16(b) | ((uint32_t)getU16(b + 2) << 16); }
+
+//decoding is shared with the library (CH224Q_PDO_Decoder.cpp), only the output format is specific to this tool
+static void printPDO(uint8_t index, uint32_t raw)
+{
+    PDOInfo pdo = decodePDO(raw);
+
+    printf("pdo=%u raw=0x%08X ", index, raw);
+    switch (pdo.type) {
+        case PDOType::Fixed:
+            printf("type=fixed voltage_mV=%u current_mA=%u\n", pdo.min_voltage_mV, pdo.max_current_mA);
+            break;
+        case PDOType::Battery:
+            printf("type=battery min_mV=%u max_mV=%u power_mW=%u\n", pdo.min_voltage_mV, pdo.max_voltage_mV, pdo.max_power_mW);
+            break;
+        case PDOType::Variable:
+            printf("type=variable min_mV=%u max_mV=%u current_mA=%u\n", pdo.min_voltage_mV, pdo.max_voltage_mV, pdo.max_current_mA);
+            break;
+        case PDOType::Augmented:
+            if (pdo.apdo_type == APDO_EPR_AVS)
+                printf("type=epr_avs min_mV=%u max_mV=%u power_mW=%u\n", pdo.min_voltage_mV, pdo.max_voltage_mV, pdo.max_power_mW);
+            else
+                printf("type=%s min_mV=%u max_mV=%u current_mA=%u\n", (pdo.apdo_type == APDO_SPR_AVS) ? "spr_avs" : "pps",
+                       pdo.min_voltage_mV, pdo.max_voltage_mV, pdo.max_current_mA);
+            break;
+        default:
+            printf("type=unknown\n");
+            break;
+    }
+}
+
+static int parseMode(const char* s, uint8_t* mode)
+{
+    static const struct { const char* name; uint8_t mode; } modes[] = {
+        {"5", CH224Q_MODE_5V}, {"9", CH224Q_MODE_9V}, {"12", CH224Q_MODE_12V}, {"15", CH224Q_MODE_15V},
+        {"20", CH224Q_MODE_20V}, {"28", CH224Q_MODE_28V}, {"pps", CH224Q_MODE_PPS}, {"avs", CH224Q_MODE_AVS},
+    };
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        if (strcmp(s, modes[i].name) == 0) {
+            *mode = modes[i].mode;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int usage()
+{
+    fprintf(stderr, "usage: ch224q_ctl [-b baud] [-t timeout_ms] [-w wait_ms] <port> "
+                    "<ping|caps|status|current|mode <5|9|12|15|20|28|pps|avs>|pps <mV>|avs <mV>|stream <period_ms> [n]>\n");
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    long baud = 115200;
+    int wait_ms = 0; //boards which reset when the port is opened need ~2000ms here
+
+    int opt;
+    while ((opt = getopt(argc, argv, "b:t:w:")) != -1) {
+        switch (opt) {
+            case 'b': baud = strtol(optarg, NULL, 10); break;
+            case 't': timeout_ms = atoi(optarg); break;
+            case 'w': wait_ms = atoi(optarg); break;
+            default:  return usage();
+        }
+    }
+    if (argc - optind < 2)
+        return usage();
+
+    const char* port = argv[optind];
+    const char* command = argv[optind + 1];
+    char** args = &argv[optind + 2];
+    int nargs = argc - optind - 2;
+
+    if (openPort(port, baud) != 0)
+        return 1;
+    if (wait_ms > 0) {
+        usleep(wait_ms * 1000);
+        tcflush(fd, TCIFLUSH); //drop whatever the sketch printed while booting
+    }
+
+    Frame reply;
+    uint8_t payload[2];
+    int err;
+
+    if (strcmp(command, "ping") == 0) {
+        if ((err = transact(CH224Q_CMD_PING, NULL, 0, &reply)) != 0) return err;
+        printf("version=%u\n", reply.payload[1]);
+    }
+    else if (strcmp(command, "caps") == 0) {
+        if ((err = transact(CH224Q_CMD_GET_CAPS, NULL, 0, &reply)) != 0) return err;
+        uint8_t count = reply.payload[1];
+        printf("count=%u\n", count);
+        for (uint8_t i = 0; i < count && (2 + i * 4 + 4) <= reply.len; i++)
+            printPDO(i, getU32(&reply.payload[2 + i * 4]));
+    }
+    else if (strcmp(command, "status") == 0) {
+        if ((err = transact(CH224Q_CMD_GET_STATUS, NULL, 0, &reply)) != 0) return err;
+        printf("status=0x%02X mode=0x%02X\n", reply.payload[1], reply.payload[2]);
+    }
+    else if (strcmp(command, "current") == 0) {
+        if ((err = transact(CH224Q_CMD_GET_CURRENT, NULL, 0, &reply)) != 0) return err;
+        printf("current_mA=%u\n", getU16(&reply.payload[1]));
+    }
+    else if (strcmp(command, "mode") == 0) {
+        if (nargs < 1 || parseMode(args[0], &payload[0]) != 0) return usage();
+        if ((err = transact(CH224Q_CMD_SET_MODE, payload, 1, &reply)) != 0) return err;
+        printf("result=0\n");
+    }
+    else if (strcmp(command, "pps") == 0 || strcmp(command, "avs") == 0) {
+        if (nargs < 1) return usage();
+        long mV = strtol(args[0], NULL, 10);
+        if (mV <= 0 || mV > 0xFFFF) return usage();
+        payload[0] = mV & 0xFF;
+        payload[1] = (mV >> 8) & 0xFF;
+        uint8_t cmd = (command[0] == 'p') ? CH224Q_CMD_SET_PPS : CH224Q_CMD_SET_AVS;
+        if ((err = transact(cmd, payload, 2, &reply)) != 0) return err;
+        printf("result=0\n");
+    }
+    else if (strcmp(command, "stream") == 0) {
+        if (nargs < 1) return usage();
+        long period = strtol(args[0], NULL, 10);
+        long count = (nargs >= 2) ? strtol(args[1], NULL, 10) : -1;
+        if (period <= 0 || period > 0xFFFF) return usage();
+        payload[0] = period & 0xFF;
+        payload[1] = (period >> 8) & 0xFF;
+        if ((err = transact(CH224Q_CMD_STREAM, payload, 2, &reply)) != 0) return err;
+
+        //no SA_RESTART, so Ctrl-C also interrupts a poll() waiting for the next frame
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = onSigint;
+        sigaction(SIGINT, &sa, NULL);
+
+        Frame f;
+        for (long n = 0; (count < 0 || n < count) && !interrupted; ) {
+            if (readFrame(&f, (int)period + timeout_ms) != 0) {
+                if (interrupted)
+                    break;
+                fprintf(stderr, "error: telemetry stream stalled\n");
+                return 1;
+            }
+            if (f.cmd != CH224Q_CMD_TELEMETRY || f.len < 8)
+                continue;
+            printf("t_ms=%u status=0x%02X mode=0x%02X current_mA=%u\n",
+                   getU32(&f.payload[0]), f.payload[4], f.payload[5], getU16(&f.payload[6]));
+            fflush(stdout);
+            n++;
+        }
+
+        signal(SIGINT, SIG_DFL); //a second Ctrl-C while stopping the stream exits right away
+        interrupted = 0;
+        payload[0] = payload[1] = 0; //stop the stream again
+        if ((err = transact(CH224Q_CMD_STREAM, payload, 2, &reply)) != 0) return err;
+    }
+    else {
+        return usage();
+    }
+
+    close(fd);
+    return 0;
+}
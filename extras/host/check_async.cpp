@@ -0,0 +1,151 @@
+/*
+ * check_async.cpp - coroutine layer (CH224Q_Async.h) against two emulated CH224Q
+ *
+ *  - two devices negotiated concurrently from one scheduler
+ *  - a task destroyed while suspended (runUntilDone() timeout, nested setMode()) leaves no waiter behind
+ *  - a task run again after a runUntilDone() timeout continues waiting instead of skipping its wait
+ *  - setMode() waits for the new contract of a slow PSU, not just for the (stale) status bits
+ *  - a full waiter table makes co_await fail instead of suspending forever
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <CH224Q_Async.h>
+#include "emu/check.h"
+
+#ifndef CH224Q_HAS_COROUTINES
+#error "check_async needs a compiler with coroutine support (-std=c++20)"
+#endif
+
+
+static CH224Q_Scheduler scheduler;
+
+static CH224Q_Task negotiate(CH224Q_Async& dev, uint16_t pps_mV, int8_t* result, uint32_t* done_ms)
+{
+    *result = co_await dev.setMode(CH224Q_MODE_9V);
+    if (*result == 0)
+        *result = co_await dev.requestPPS(pps_mV);
+    *done_ms = millis();
+    co_return *result;
+}
+
+static CH224Q_Task nested(CH224Q_Async& dev)
+{
+    co_return co_await dev.requestPPS(9000); //suspends inside the nested setMode()
+}
+
+static CH224Q_Task sleeper(int8_t* result)
+{
+    *result = co_await scheduler.sleep_ms(10);
+    co_return 0;
+}
+
+
+int main()
+{
+    Serial.quiet = true; //failed handshakes are provoked on purpose
+
+    const uint32_t caps[] = {fixedPDO(5000, 3000), fixedPDO(9000, 2000), ppsAPDO(3300, 21000, 3000)};
+    Wire.setSourceCaps(caps, 3);
+    Wire1.setSourceCaps(caps, 3);
+    Wire.handshake_ms = 150;
+    Wire1.handshake_ms = 150;
+
+    CH224Q a(&Wire), b(&Wire1);
+    CH224Q_Async devA(&a, &scheduler), devB(&b, &scheduler);
+
+    //both devices wait at the same time, so together they take about as long as one
+    {
+        int8_t resultA = 1, resultB = 1;
+        uint32_t doneA = 0, doneB = 0;
+        uint32_t start = millis();
+        scheduler.spawn(negotiate(devA, 9000, &resultA, &doneA));
+        scheduler.spawn(negotiate(devB, 12000, &resultB, &doneB));
+        while (!scheduler.idle()) {
+            scheduler.poll();
+            yield();
+        }
+
+        CHECK(resultA == 0 && resultB == 0);
+        CHECK(doneA - start < 3 * Wire.handshake_ms); //two contracts each, one after the other would take twice as long
+        CHECK(doneB - start < 3 * Wire.handshake_ms);
+        CHECK(scheduler.idle());
+
+        CHECK(a.getMaxCurrent_mA() == 3000 && b.getMaxCurrent_mA() == 3000);
+        CHECK(a.getMode() == CH224Q_MODE_PPS && Wire.contractMode == CH224Q_MODE_PPS && Wire.contractVoltage_mV == 9000);
+        CHECK(b.getMode() == CH224Q_MODE_PPS && Wire1.contractMode == CH224Q_MODE_PPS && Wire1.contractVoltage_mV == 12000);
+    }
+
+    //runUntilDone() times out while the task waits, then the task goes out of scope
+    Wire1.protocol = 0; //PSU doesn't answer anymore
+    {
+        CH224Q_Task t = devB.setMode(CH224Q_MODE_5V);
+        CHECK(scheduler.runUntilDone(t, 50) == -1);
+        CHECK(!t.done());
+        CHECK(!scheduler.idle());
+    }
+    CHECK(scheduler.idle());
+    delay(5000);
+    scheduler.poll(); //must not resume the destroyed frame
+
+    //outer task destroyed while the nested setMode() inside requestPPS() is suspended
+    a.setMode(CH224Q_MODE_5V);
+    {
+        CH224Q_Task t = nested(devA);
+        CHECK(scheduler.runUntilDone(t, 20) == -1);
+        CHECK(!scheduler.idle());
+    }
+    CHECK(scheduler.idle());
+    delay(5000);
+    scheduler.poll();
+
+    //a suspended task can still be finished after a runUntilDone() timeout, a slow PSU is waited for
+    Wire1.protocol = CH224Q_STATUS_PD_ACTIVATED;
+    Wire1.handshake_ms = 600;
+    {
+        uint32_t start = millis();
+        CH224Q_Task t = devB.setMode(CH224Q_MODE_9V);
+        CHECK(scheduler.runUntilDone(t, 20) == -1);
+        CHECK(scheduler.runUntilDone(t, 5000) == 0);
+        CHECK(millis() - start >= Wire1.handshake_ms);
+        CHECK(b.getMode() == CH224Q_MODE_9V && Wire1.contractMode == CH224Q_MODE_9V && b.getMaxCurrent_mA() == 2000);
+    }
+    Wire1.handshake_ms = 150;
+
+    //same with the nested setMode() of requestPPS() and a PSU which doesn't answer: fails after the full wait
+    a.setMode(CH224Q_MODE_5V);
+    delay(Wire.handshake_ms);
+    Wire.protocol = 0;
+    {
+        uint32_t start = millis();
+        CH224Q_Task t = devA.requestPPS(9000);
+        CHECK(scheduler.runUntilDone(t, 20) == -1);
+        scheduler.runUntilDone(t, 5000);
+        CHECK(t.done() && t.result() == -1);
+        CHECK(millis() - start >= CH224Q_MODE_SETTLE_MS + CH224Q_ASYNC_HANDSHAKE_TIMEOUT_MS);
+        CHECK(a.getMode() != CH224Q_MODE_PPS && Wire.contractMode == CH224Q_MODE_5V);
+    }
+    Wire.protocol = CH224Q_STATUS_PD_ACTIVATED;
+
+    //more sleeping coroutines than waiter slots: the extra ones continue right away with -1
+    {
+        int8_t results[CH224Q_ASYNC_MAX_WAITERS + 2];
+        for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS + 2; i++) {
+            results[i] = 1;
+            scheduler.spawn(sleeper(&results[i]));
+        }
+        CHECK(results[CH224Q_ASYNC_MAX_WAITERS] == -1 && results[CH224Q_ASYNC_MAX_WAITERS + 1] == -1);
+        while (!scheduler.idle()) {
+            scheduler.poll();
+            yield();
+        }
+        for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS; i++)
+            CHECK(results[i] == 0);
+    }
+
+    CHECK(Wire.invalidModeWrites == 0 && Wire1.invalidModeWrites == 0);
+
+    return CHECK_RESULT("check_async");
+}
@@ -0,0 +1,120 @@
+/*
+ * check_budget.cpp - power-budget scheduler (CH224Q_PowerBudget.h) against two emulated CH224Q
+ *
+ *  - an idle port without source capabilities (QC supply) gets 5V, never an invalid mode
+ *  - overlapping PPS APDOs: the current comes from the APDO covering the voltage
+ *  - the budget is split by priority
+ *  - if lowering a port fails, no other port is raised
+ *  - with a slow handshake the granted current isn't taken from the previous contract
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <CH224Q_PowerBudget.h>
+#include "emu/check.h"
+
+
+int main()
+{
+    Serial.quiet = true; //failed handshakes are provoked on purpose
+
+    //idle QC supply next to a PD supply whose PPS APDOs overlap, only the second one covers 15V
+    {
+        const uint32_t caps[] = {fixedPDO(5000, 3000), fixedPDO(9000, 3000), ppsAPDO(3300, 11000, 5000), ppsAPDO(3300, 21000, 3000)};
+        Wire.setSourceCaps(caps, 4);
+        Wire1.setSourceCaps(nullptr, 0);
+        Wire1.protocol = CH224Q_STATUS_QC2_ACTIVATED;
+
+        CH224Q a(&Wire), b(&Wire1);
+        a.begin();
+        b.begin();
+
+        CH224Q_PowerBudget budget(60000); //enough for 15V @ 3A, not for the 4.5A the first APDO offers
+        CHECK(budget.addPort(&a, 2) == 0);
+        CHECK(budget.addPort(&b, 1) == 1);
+        budget.setDemand(0, 15000, 4500);
+
+        CHECK(budget.rebalance() == 0);
+        const CH224Q_PortContract* c = budget.getContract(0);
+        CHECK(c->mode == CH224Q_MODE_PPS && c->voltage_mV == 15000);
+        CHECK(c->current_mA == 3000 && c->power_mW == 45000);
+        c = budget.getContract(1);
+        CHECK(c->mode == CH224Q_MODE_5V && c->power_mW == 0);
+        CHECK(Wire1.invalidModeWrites == 0);
+
+        delay(1000);
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getRenegotiations() == 0); //nothing changed
+        CHECK(Wire.invalidModeWrites == 0 && Wire1.invalidModeWrites == 0);
+        CHECK(Wire.contractMode == CH224Q_MODE_PPS && Wire.contractVoltage_mV == 15000);
+    }
+
+    //two PD supplies, only the port with the higher priority fits at 20V
+    {
+        const uint32_t caps[] = {fixedPDO(5000, 3000), fixedPDO(20000, 3000)};
+        Wire.setSourceCaps(caps, 2);
+        Wire1.setSourceCaps(caps, 2);
+        Wire1.protocol = CH224Q_STATUS_PD_ACTIVATED;
+
+        CH224Q a(&Wire), b(&Wire1);
+        a.begin();
+        b.begin();
+
+        CH224Q_PowerBudget budget(80000);
+        budget.addPort(&a, 2);
+        budget.addPort(&b, 1);
+        budget.setDemand(0, 20000, 3000);
+        budget.setDemand(1, 20000, 3000);
+
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getContract(0)->voltage_mV == 20000 && budget.getContract(1)->voltage_mV == 5000);
+        CHECK(budget.getAllocated_mW() == 75000);
+
+        //port 0 goes idle but doesn't answer anymore, so port 1 must not be raised
+        uint16_t writes = Wire1.modeWrites;
+        Wire.protocol = 0;
+        budget.setDemand(0, 0, 0);
+        CHECK(budget.rebalance() == -1);
+        CHECK(Wire1.modeWrites == writes);
+        CHECK(budget.getContract(1)->voltage_mV == 5000);
+        CHECK(Wire.contractVoltage_mV + Wire1.contractVoltage_mV == 25000);
+
+        //once port 0 answers again the raise follows
+        Wire.protocol = CH224Q_STATUS_PD_ACTIVATED;
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getContract(0)->voltage_mV == 5000 && budget.getContract(1)->voltage_mV == 20000);
+        CHECK(budget.getAllocated_mW() <= 80000);
+        CHECK(Wire1.contractMode == CH224Q_MODE_20V);
+    }
+
+    //the current register still shows 9V @ 2A when setMode() returns
+    {
+        const uint32_t caps[] = {fixedPDO(5000, 3000), fixedPDO(9000, 2000)};
+        Wire.setSourceCaps(caps, 2);
+        Wire.handshake_ms = 300;
+
+        CH224Q a(&Wire);
+        a.begin();
+
+        CH224Q_PowerBudget budget(100000);
+        budget.addPort(&a, 1);
+        budget.setDemand(0, 9000, 3000);
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getContract(0)->current_mA == 2000);
+        delay(Wire.handshake_ms);
+
+        budget.setDemand(0, 5000, 3000);
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getContract(0)->mode == CH224Q_MODE_5V && budget.getContract(0)->current_mA == 3000);
+        CHECK(budget.getAllocated_mW() == 15000);
+
+        delay(Wire.handshake_ms);
+        CHECK(budget.rebalance() == 0);
+        CHECK(budget.getRenegotiations() == 0 && budget.getAllocated_mW() == 15000);
+        Wire.handshake_ms = 0;
+    }
+
+    return CHECK_RESULT("check_budget");
+}
@@ -0,0 +1,75 @@
+#!/bin/sh
+# check_protocol.sh - drives ch224q_ctl against emu_device over a pty, called by "make check"
+# Usage: ./check_protocol.sh [build directory]
+
+BUILD=${1:-build}
+CTL="$BUILD/ch224q_ctl"
+TMP=$(mktemp -d)
+failed=0
+
+"$BUILD/emu_device" > "$TMP/device" &
+device=$!
+trap 'kill $device 2>/dev/null; rm -rf "$TMP"' EXIT
+
+for i in $(seq 50); do
+    pty=$(head -n 1 "$TMP/device")
+    [ -n "$pty" ] && break
+    sleep 0.1
+done
+if [ -z "$pty" ]; then
+    echo "check_protocol: emu_device didn't start"
+    exit 1
+fi
+
+# expect <exit code> <pattern> <ch224q_ctl arguments...>
+expect() {
+    code=$1
+    pattern=$2
+    shift 2
+    "$CTL" "$pty" "$@" > "$TMP/out" 2>&1
+    rc=$?
+    if [ $rc -ne "$code" ] || ! grep -q -- "$pattern" "$TMP/out"; then
+        echo "check_protocol: ch224q_ctl $* returned $rc, expected $code and \"$pattern\":"
+        cat "$TMP/out"
+        failed=$((failed + 1))
+    fi
+}
+
+expect 0 "^version=1$" ping
+expect 0 "^count=7$" caps
+expect 0 "^pdo=1 raw=0x0002D12C type=fixed voltage_mV=9000 current_mA=3000$" caps
+expect 0 "^pdo=5 raw=.* type=pps min_mV=3300 max_mV=21000 current_mA=3000$" caps
+expect 0 "^pdo=6 raw=.* type=epr_avs min_mV=15000 max_mV=28000 power_mW=140000$" caps
+expect 0 "^result=0$" mode 12
+expect 0 "^status=0x08 mode=0x02$" status
+expect 0 "^current_mA=3000$" current
+expect 0 "^result=0$" pps 9000
+expect 0 "^status=0x08 mode=0x06$" status
+expect 0 "^result=0$" avs 20000
+expect 0 "^current_mA=5000$" current
+expect 0 "^result=0$" avs 28000
+expect 0 "^status=0x08 mode=0x07$" status
+expect 2 "^result=-1$" avs 40
+expect 1 "usage" mode 11
+expect 0 "^t_ms=.* status=0x08 mode=0x07 current_mA=5000$" stream 20 3
+
+# Ctrl-C on an endless stream has to stop the stream on the device before exiting
+timeout --preserve-status -s INT -k 2 0.5 "$CTL" "$pty" stream 20 > "$TMP/stream" 2>&1
+rc=$?
+if [ $rc -ne 0 ] || ! grep -q "^t_ms=" "$TMP/stream"; then
+    echo "check_protocol: stream interrupted by SIGINT returned $rc, expected 0:"
+    head -n 5 "$TMP/stream"
+    failed=$((failed + 1))
+fi
+sleep 0.2
+timeout 0.5 cat "$pty" > "$TMP/after"
+if [ -s "$TMP/after" ]; then
+    echo "check_protocol: device still streams telemetry after SIGINT"
+    failed=$((failed + 1))
+fi
+
+if [ $failed -ne 0 ]; then
+    echo "check_protocol: FAILED ($failed failed)"
+    exit 1
+fi
+echo "check_protocol: ok (0 failed)"
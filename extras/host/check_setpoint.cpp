@@ -0,0 +1,43 @@
+/*
+ * check_setpoint.cpp - range-checked setPPSVoltage_mv()/setAVSVoltage_mv() against the emulated CH224Q
+ *
+ *  - every APDO keeps its own range: voltages in a gap between two PPS APDOs are rejected without I2C traffic
+ *  - AVS voltages are checked against the EPR AVS APDO only, not against the PPS ranges
+ *  - requests below the lowest AVS voltage never reach the chip
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <CH224Q_Arduino.h>
+#include "emu/check.h"
+
+
+int main()
+{
+    const uint32_t caps[] = {fixedPDO(5000, 3000), ppsAPDO(3300, 5900, 3000), ppsAPDO(8000, 11000, 3000), eprAvsAPDO(21000, 28000, 140)};
+    Wire.setSourceCaps(caps, 4);
+
+    CH224Q ch;
+    ch.begin();
+    CHECK(ch.refreshCapabilities() == 0);
+    CHECK(ch.getPPSMinVoltage_mv() == 3300 && ch.getPPSMaxVoltage_mv() == 11000);
+
+    uint16_t programmed_mV = 0;
+    CHECK(ch.setPPSVoltage_mv(9040, programmed_mV) == 0 && programmed_mV == 9000);
+    CHECK(Wire.contractMode == CH224Q_MODE_PPS && Wire.contractVoltage_mV == 9000);
+
+    //between the two PPS APDOs
+    uint16_t writes = Wire.registerWrites;
+    CHECK(ch.setPPSVoltage_mv(7000, programmed_mV) == -1);
+    //only EPR AVS, which starts at 21V
+    CHECK(ch.setAVSVoltage_mv(18000, programmed_mV) == -1);
+    CHECK(ch.writeAVSVoltage_mv(40) == -1);
+    CHECK(Wire.registerWrites == writes);
+
+    CHECK(ch.setAVSVoltage_mv(25000, programmed_mV) == 0 && programmed_mV == 25000);
+    CHECK(Wire.contractMode == CH224Q_MODE_AVS && Wire.contractVoltage_mV == 25000);
+
+    return CHECK_RESULT("check_setpoint");
+}
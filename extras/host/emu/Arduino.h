@@ -0,0 +1,105 @@
+/*
+    Arduino.h - Minimal Arduino core for building the CH224Q library on a Linux host
+    Only what the library and the host checks use. Time is a virtual clock which only advances
+    in delay(), yield() and I2C transfers, so checks run instantly and produce the same result on every run.
+    Part of the host harness in extras/host, see the Makefile there.
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#define HEX 16
+#define DEC 10
+
+typedef bool boolean;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void yield(); //advances the virtual clock by 1ms, so busy loops calling yield() make progress
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+
+class String {
+public:
+
+    String() {}
+    String(const char* s) : str(s) {}
+    String(float value, unsigned char decimals = 2);
+
+    String operator+(const String& other) const { return String(str + other.str); }
+    String operator+(const char* other) const { return String(str + other); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.str); }
+
+    const char* c_str() const { return str.c_str(); }
+    unsigned int length() const { return str.length(); }
+
+private:
+
+    explicit String(const std::string& s) : str(s) {}
+
+    std::string str;
+
+};
+
+
+class Print {
+public:
+
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* s);
+    size_t print(const __FlashStringHelper* s);
+    size_t print(const String& s);
+    size_t print(char c);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+
+    size_t println();
+    template<typename T> size_t println(T value) { return print(value) + println(); }
+    template<typename T> size_t println(T value, int base) { return print(value, base) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+};
+
+
+class Stream : public Print {
+public:
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+
+};
+
+
+//Serial writes to stdout and never receives anything
+class HardwareSerial : public Stream {
+public:
+
+    void begin(unsigned long) {}
+    operator bool() { return true; }
+
+    size_t write(uint8_t b) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+
+    bool quiet = false; //set by checks which provoke library error messages on purpose
+
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,66 @@
+/*
+    Wire.h - TwoWire with a register-level emulation of a CH224Q and the PSU connected to it
+    Behaves like the chip as far as the library can see it over I2C:
+     - source capabilities at CH224Q_SRCCAP_START, set with setSourceCaps()
+     - a mode request is accepted if the PSU offers a matching (A)PDO. The new current limit shows up in
+       CH224Q_CURRENT_CAPABILTY after handshake_ms, a rejected request keeps the previous contract
+     - CH224Q_STATUS keeps the protocol bits of the previous contract during a renegotiation, like the chip does
+     - invalid values written to CH224Q_VOLTAGEMODE_CTRL are counted, not executed
+    Every bus (Wire, Wire1 or own instances) is one independent chip.
+    Part of the host harness in extras/host, see the Makefile there.
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include "Arduino.h"
+#include "CH224Q_Registers.h"
+
+
+class TwoWire {
+public:
+
+    //I2C interface as used by the library
+    void begin() {}
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t b);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(int address, int quantity);
+    int available();
+    int read();
+
+    //emulation setup
+    void setSourceCaps(const uint32_t* pdos, uint8_t count); //count = 0: non-PD supply without source capabilities
+    uint8_t protocol = CH224Q_STATUS_PD_ACTIVATED; //status bits of a successful handshake, 0 = PSU doesn't answer at all
+    uint32_t handshake_ms = 0;        //time until a new contract is in place
+    bool present = true;              //false: every transfer is NACKed
+
+    //what happened on the bus
+    uint8_t regs[256] = {0};          //as last written by the library, read-only registers as seen by it
+    uint16_t registerWrites = 0;
+    uint16_t modeWrites = 0;          //accepted and rejected requests
+    uint16_t rejectedModes = 0;       //requests the PSU doesn't offer, previous contract stays
+    uint16_t invalidModeWrites = 0;   //values outside of CH224Q_MODE_5V..CH224Q_MODE_AVS
+    int16_t contractMode = -1;        //mode of the contract in place, -1 = none (yet)
+    uint16_t contractVoltage_mV = 0;
+
+private:
+
+    void onWrite(uint8_t reg, uint8_t value);
+    void negotiate(uint8_t mode);
+    void update(); //applies a pending contract once handshake_ms passed
+
+    uint8_t pointer = 0;
+    uint8_t txBytes = 0;
+    int rxLeft = 0;
+
+    bool pending = false;
+    uint32_t pendingSince_ms = 0;
+    int16_t pendingMode = -1;
+    uint16_t pendingVoltage_mV = 0;
+    uint16_t pendingCurrent_mA = 0;
+
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
@@ -0,0 +1,45 @@
+/*
+    check.h - Helpers shared by the host checks in extras/host
+    CHECK() records a failure and continues, CHECK_RESULT() prints the summary and is the exit code of main().
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+static int check_failures __attribute__((unused)) = 0; //not every user of the PDO helpers below is a check
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            check_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_RESULT(name) \
+    (printf("%s: %s (%d failed)\n", name, check_failures ? "FAILED" : "ok", check_failures), check_failures ? 1 : 0)
+
+
+//source capability encodings, see CH224Q_PDO_Decoder.h
+static inline uint32_t fixedPDO(uint32_t voltage_mV, uint32_t current_mA)
+{
+    return ((voltage_mV / 50) << 10) | (current_mA / 10);
+}
+
+static inline uint32_t ppsAPDO(uint32_t min_mV, uint32_t max_mV, uint32_t current_mA)
+{
+    return (3u << 30) | ((max_mV / 100) << 17) | ((min_mV / 100) << 8) | (current_mA / 50);
+}
+
+static inline uint32_t eprAvsAPDO(uint32_t min_mV, uint32_t max_mV, uint32_t power_W)
+{
+    return (3u << 30) | (1u << 28) | ((max_mV / 100) << 17) | ((min_mV / 100) << 8) | power_W;
+}
+
+static inline uint32_t sprAvsAPDO(uint32_t current15V_mA, uint32_t current20V_mA)
+{
+    return (3u << 30) | (2u << 28) | ((current15V_mA / 10) << 10) | (current20V_mA / 10);
+}
@@ -0,0 +1,282 @@
+#include "Arduino.h"
+#include "Wire.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+
+
+//voltages of the fixed modes, indexed by CH224Q_MODE_5V..CH224Q_MODE_28V
+static const uint16_t fixedVoltages_mV[6] = {5000, 9000, 12000, 15000, 20000, 28000};
+
+//time a byte takes on a 100kHz I2C bus (8 data bits + ACK), so loops polling a register make progress like on hardware
+#define EMU_I2C_BYTE_US 90
+
+static uint32_t now_us = 0;
+
+
+static uint16_t min5A(uint32_t current_mA)
+{
+    return (current_mA > 5000) ? 5000 : current_mA; //USB-PD never goes above 5A
+}
+
+HardwareSerial Serial;
+TwoWire Wire;
+TwoWire Wire1;
+
+
+uint32_t millis()
+{
+    return now_us / 1000;
+}
+
+uint32_t micros()
+{
+    return now_us;
+}
+
+void delay(uint32_t ms)
+{
+    now_us += ms * 1000;
+}
+
+void yield()
+{
+    now_us += 1000;
+}
+
+
+String::String(float value, unsigned char decimals)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+    str = buf;
+}
+
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::print(const char* s)
+{
+    size_t n = 0;
+    while (*s)
+        n += write((uint8_t)*s++);
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper* s)
+{
+    return print(reinterpret_cast<const char*>(s));
+}
+
+size_t Print::print(const String& s)
+{
+    return print(s.c_str());
+}
+
+size_t Print::print(char c)
+{
+    return write((uint8_t)c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == DEC && value < 0)
+        return print('-') + print((unsigned long)-value, base);
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char buf[24];
+    snprintf(buf, sizeof(buf), (base == HEX) ? "%lX" : "%lu", value);
+    return print(buf);
+}
+
+size_t Print::println()
+{
+    return print("\r\n");
+}
+
+size_t Print::printf(const char* format, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    return print(buf);
+}
+
+size_t HardwareSerial::write(uint8_t b)
+{
+    if (!quiet && b != '\r')
+        putchar(b);
+    return 1;
+}
+
+
+void TwoWire::beginTransmission(uint8_t)
+{
+    txBytes = 0;
+    now_us += EMU_I2C_BYTE_US; //address byte
+}
+
+size_t TwoWire::write(uint8_t b)
+{
+    now_us += EMU_I2C_BYTE_US;
+    if (txBytes++ == 0)
+        pointer = b; //first byte selects the register
+    else
+        onWrite(pointer++, b);
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    return present ? 0 : 2; //2 = NACK on address
+}
+
+uint8_t TwoWire::requestFrom(int, int quantity)
+{
+    now_us += EMU_I2C_BYTE_US * (1 + quantity);
+    rxLeft = present ? quantity : 0;
+    return rxLeft;
+}
+
+int TwoWire::available()
+{
+    return rxLeft;
+}
+
+int TwoWire::read()
+{
+    if (rxLeft <= 0)
+        return -1;
+    rxLeft--;
+
+    update();
+    if (pointer == CH224Q_STATUS)
+        regs[pointer] = protocol;
+    return regs[pointer++];
+}
+
+void TwoWire::setSourceCaps(const uint32_t* pdos, uint8_t count)
+{
+    for (uint8_t reg = CH224Q_SRCCAP_START; reg <= CH224Q_SRCCAP_END; reg++)
+        regs[reg] = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t b = 0; b < 4; b++)
+            regs[CH224Q_SRCCAP_START + i * 4 + b] = (pdos[i] >> (8 * b)) & 0xFF;
+    }
+
+    //the PSU starts with its 5V PDO, which is always the first one
+    pending = false;
+    contractMode = (count > 0) ? CH224Q_MODE_5V : -1;
+    contractVoltage_mV = (count > 0) ? 5000 : 0;
+    regs[CH224Q_CURRENT_CAPABILTY] = (count > 0) ? (pdos[0] & 0x3FF) * 10 / 50 : 0;
+}
+
+void TwoWire::onWrite(uint8_t reg, uint8_t value)
+{
+    regs[reg] = value;
+    registerWrites++;
+
+    if (reg == CH224Q_VOLTAGEMODE_CTRL)
+        negotiate(value);
+    else if (reg == CH224Q_PPS_VOLTAGE_CTRL && contractMode == CH224Q_MODE_PPS)
+        negotiate(CH224Q_MODE_PPS); //new voltage within the running PPS contract
+    else if (reg == CH224Q_AVX_CTRL1 && contractMode == CH224Q_MODE_AVS)
+        negotiate(CH224Q_MODE_AVS); //high byte is written last and completes the AVS voltage
+}
+
+void TwoWire::negotiate(uint8_t mode)
+{
+    if (mode > CH224Q_MODE_AVS) {
+        invalidModeWrites++;
+        return;
+    }
+    modeWrites++;
+    update(); //a contract still pending is either in place by now or replaced by this request
+
+    uint16_t voltage_mV = 0;
+    if (mode <= CH224Q_MODE_28V)
+        voltage_mV = fixedVoltages_mV[mode];
+    else if (mode == CH224Q_MODE_PPS)
+        voltage_mV = regs[CH224Q_PPS_VOLTAGE_CTRL] * CH224Q_PPS_LSB_MV;
+    else if (regs[CH224Q_AVX_CTRL1] & CH224Q_AVX_ENABLE)
+        voltage_mV = (((regs[CH224Q_AVX_CTRL1] & 0x7F) << 8) | regs[CH224Q_AVX_CTRL2]) * CH224Q_AVS_LSB_MV;
+
+    //look for a (A)PDO covering the request, decoded here independently of the library's decoder
+    uint16_t current_mA = 0;
+    for (uint8_t reg = CH224Q_SRCCAP_START; voltage_mV != 0 && reg + 3 <= CH224Q_SRCCAP_END && current_mA == 0; reg += 4) {
+        uint32_t pdo = (uint32_t)regs[reg] | ((uint32_t)regs[reg + 1] << 8) | ((uint32_t)regs[reg + 2] << 16) | ((uint32_t)regs[reg + 3] << 24);
+        if (pdo == 0)
+            break;
+
+        bool augmented = (pdo >> 30) == 3;
+        uint8_t apdo = (pdo >> 28) & 0x3;
+        uint32_t min_mV = ((pdo >> 8) & 0xFF) * 100;
+
+        if (!augmented && (pdo >> 30) == 0 && mode <= CH224Q_MODE_28V) {
+            if (((pdo >> 10) & 0x3FF) * 50 == voltage_mV)
+                current_mA = (pdo & 0x3FF) * 10;
+        }
+        else if (augmented && apdo == 0 && mode == CH224Q_MODE_PPS) {
+            if (voltage_mV >= min_mV && voltage_mV <= ((pdo >> 17) & 0xFF) * 100)
+                current_mA = (pdo & 0x7F) * 50;
+        }
+        else if (augmented && apdo == 1 && mode == CH224Q_MODE_AVS) {
+            if (voltage_mV >= min_mV && voltage_mV <= ((pdo >> 17) & 0x1FF) * 100)
+                current_mA = min5A((uint32_t)(pdo & 0xFF) * 1000000 / voltage_mV); //PDP in W
+        }
+        else if (augmented && apdo == 2 && mode == CH224Q_MODE_AVS) {
+            if (voltage_mV >= 9000 && voltage_mV <= 20000)
+                current_mA = ((voltage_mV <= 15000) ? (pdo >> 10) & 0x3FF : pdo & 0x3FF) * 10;
+        }
+    }
+
+    if (!(protocol & (CH224Q_STATUS_PD_ACTIVATED | CH224Q_STATUS_EPR_ACTIVATED)) || current_mA == 0) {
+        rejectedModes++; //not offered (or no PD at all), previous contract stays
+        return;
+    }
+
+    pending = true;
+    pendingSince_ms = millis();
+    pendingMode = mode;
+    pendingVoltage_mV = voltage_mV;
+    pendingCurrent_mA = current_mA;
+    update();
+}
+
+void TwoWire::update()
+{
+    if (!pending || (millis() - pendingSince_ms) < handshake_ms)
+        return;
+
+    pending = false;
+    contractMode = pendingMode;
+    contractVoltage_mV = pendingVoltage_mV;
+    uint32_t raw = pendingCurrent_mA / 50;
+    regs[CH224Q_CURRENT_CAPABILTY] = (raw > 0xFF) ? 0xFF : raw;
+}
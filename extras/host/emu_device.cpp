@@ -0,0 +1,110 @@
+/*
+ * emu_device.cpp - examples/BinaryProtocol on the emulated CH224Q, served on a pty
+ *
+ * Prints the path of the pty on the first line and serves CH224Q_Protocol on it until killed,
+ * so ch224q_ctl can be driven end to end without hardware:
+ *   ./build/emu_device &
+ *   ./build/ch224q_ctl /dev/pts/N caps
+ *
+ * The emulated PSU offers 5/9/12/15/20V @ 3A, PPS 3.3-21V @ 3A and EPR AVS 15-28V @ 140W.
+ * Used by check_protocol.sh.
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <CH224Q_Arduino.h>
+#include <CH224Q_Protocol.h>
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#include "emu/check.h"
+
+
+//Stream on the master side of the pty, never blocks
+class PtyStream : public Stream {
+public:
+
+    PtyStream(int _fd) : fd(_fd) {}
+
+    int available() override
+    {
+        if (next < 0) {
+            uint8_t b;
+            if (::read(fd, &b, 1) == 1)
+                next = b;
+        }
+        return (next >= 0) ? 1 : 0;
+    }
+
+    int read() override
+    {
+        if (!available())
+            return -1;
+        int b = next;
+        next = -1;
+        return b;
+    }
+
+    int peek() override
+    {
+        available();
+        return next;
+    }
+
+    size_t write(uint8_t b) override
+    {
+        return (::write(fd, &b, 1) == 1) ? 1 : 0;
+    }
+    using Print::write;
+
+private:
+
+    int fd;
+    int next = -1;
+
+};
+
+
+int main()
+{
+    int master, slave;
+    char name[64];
+    if (openpty(&master, &slave, name, NULL, NULL) != 0) {
+        perror("openpty");
+        return 1;
+    }
+
+    //the slave fd stays open, so the line settings survive between two ch224q_ctl calls
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    fcntl(master, F_SETFL, O_NONBLOCK);
+
+    const uint32_t caps[] = {
+        fixedPDO(5000, 3000), fixedPDO(9000, 3000), fixedPDO(12000, 3000), fixedPDO(15000, 3000), fixedPDO(20000, 3000),
+        ppsAPDO(3300, 21000, 3000), eprAvsAPDO(15000, 28000, 140),
+    };
+    Wire.setSourceCaps(caps, sizeof(caps) / sizeof(caps[0]));
+    Serial.quiet = true; //stdout only carries the pty path
+
+    CH224Q ch224q;
+    ch224q.begin();
+
+    PtyStream stream(master);
+    CH224Q_Protocol protocol(&ch224q, &stream);
+
+    printf("%s\n", name);
+    fflush(stdout);
+
+    while (true) {
+        protocol.poll();
+        usleep(1000);
+        delay(1); //keep the virtual clock roughly in step with the host, telemetry periods are in ms
+    }
+}
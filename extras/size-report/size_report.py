@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""
+size_report.py - builds every environment of platformio.ini and checks the size budgets
+
+Flash/RAM usage is taken from the size summary PlatformIO prints after each build.
+The library cost of an environment is its usage minus the "baseline" environment.
+Results are written to size_report.csv, the exit code is 1 if any build failed or
+any environment exceeded its custom_flash_budget / custom_ram_budget.
+
+License: MIT 4R3N(cad435) 2025-12-13
+"""
+
+import configparser
+import os
+import re
+import subprocess
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+BASELINE = "baseline"
+
+# "RAM:   [=         ]   9.6% (used 197 bytes from 2048 bytes)"
+USAGE_RE = re.compile(r"^(RAM|Flash):.*\(used (\d+) bytes from \d+ bytes\)", re.MULTILINE)
+
+
+def build(env):
+    proc = subprocess.run(["pio", "run", "-e", env], cwd=HERE, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if proc.returncode != 0:
+        sys.stdout.write(proc.stdout)
+        return None
+    usage = {kind: int(used) for kind, used in USAGE_RE.findall(proc.stdout)}
+    if "RAM" not in usage or "Flash" not in usage:
+        print("error: no size summary in the output of env %s" % env)
+        return None
+    return usage
+
+
+def main():
+    config = configparser.ConfigParser()
+    config.read(os.path.join(HERE, "platformio.ini"))
+    envs = [e.strip() for e in config["platformio"]["default_envs"].split(",")]
+
+    results = {}
+    failed = False
+    for env in envs:
+        print("building %s ..." % env)
+        results[env] = build(env)
+        if results[env] is None:
+            failed = True
+
+    base = results.get(BASELINE)
+    if base is None:
+        print("error: baseline did not build, can't compute library sizes")
+        return 1
+
+    rows = ["env,flash,ram,lib_flash,lib_ram,flash_budget,ram_budget,result"]
+    print("\n%-10s %8s %8s %10s %10s  %s" % ("env", "flash", "ram", "lib flash", "lib ram", "result"))
+    for env in envs:
+        usage = results[env]
+        if usage is None:
+            rows.append("%s,,,,,,,build failed" % env)
+            print("%-10s %8s %8s %10s %10s  %s" % (env, "-", "-", "-", "-", "BUILD FAILED"))
+            continue
+
+        section = config["env:" + env]
+        flash_budget = section.getint("custom_flash_budget", fallback=None)
+        ram_budget = section.getint("custom_ram_budget", fallback=None)
+        lib_flash = usage["Flash"] - base["Flash"]
+        lib_ram = usage["RAM"] - base["RAM"]
+
+        errors = []
+        if flash_budget is not None and lib_flash > flash_budget:
+            errors.append("flash over budget (%d > %d)" % (lib_flash, flash_budget))
+        if ram_budget is not None and lib_ram > ram_budget:
+            errors.append("ram over budget (%d > %d)" % (lib_ram, ram_budget))
+        result = "; ".join(errors) if errors else "ok"
+        if errors:
+            failed = True
+
+        rows.append("%s,%d,%d,%d,%d,%s,%s,%s" % (env, usage["Flash"], usage["RAM"], lib_flash, lib_ram,
+                                                 "" if flash_budget is None else flash_budget,
+                                                 "" if ram_budget is None else ram_budget, result))
+        print("%-10s %8d %8d %10d %10d  %s" % (env, usage["Flash"], usage["RAM"], lib_flash, lib_ram, result))
+
+    with open(os.path.join(HERE, "size_report.csv"), "w") as f:
+        f.write("\n".join(rows) + "\n")
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
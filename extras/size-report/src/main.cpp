@@ -0,0 +1,57 @@
+/*
+ * Size report sketch, see platformio.ini
+ * Every configuration does the same as the library calls it enables, so the difference to
+ * "baseline" is the cost of the library itself.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#ifndef SIZE_BASELINE
+#include <CH224Q_Arduino.h>
+#endif
+
+volatile uint32_t sink; //keeps the compiler from optimising results away
+
+void setup() {
+
+#ifdef SIZE_BASELINE
+  //roughly what begin() + setMode() do, written with plain Wire calls
+  Wire.begin();
+  Wire.beginTransmission(0x22);
+  Wire.write(0x0A);
+  Wire.write(0x01);
+  sink = Wire.endTransmission();
+  delay(100);
+  Wire.beginTransmission(0x22);
+  Wire.write(0x09);
+  Wire.endTransmission(false);
+  Wire.requestFrom(0x22, 1);
+  sink = Wire.read();
+#else
+  static CH224Q ch224q;
+  sink = ch224q.begin();
+  sink = ch224q.setMode(CH224Q_MODE_9V);
+
+#ifdef SIZE_USE_PPS
+  sink = ch224q.requestPPSVoltage_mv(9000);
+#endif
+
+#ifdef SIZE_USE_DECODER
+  PDOInfo pdo = decodePDO(ch224q.getPDORawValue(0));
+  sink = pdo.max_voltage_mV;
+#endif
+
+#ifdef SIZE_USE_FORMATTING
+  String pdoStr;
+  PDO2String(pdo, &pdoStr);
+  Serial.begin(115200);
+  Serial.println(pdoStr);
+#endif
+#endif
+
+}
+
+void loop() {
+
+}
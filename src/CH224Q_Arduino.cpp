@@ -14,6 +14,7 @@ int8_t CH224Q::begin(uint8_t address)
     //Serial.println("test");
     addr = address;
     if (!wire) return -1; //return false if no wire instance
+    CapabilitiesValid = false; //PSU might have changed since the last begin()
     wire->begin(); //initialize I2C bus
 
     uint8_t value = 0;
@@ -37,7 +38,7 @@ int8_t CH224Q::begin(uint8_t address)
     if (wire->endTransmission() != 0)
         return -1; 
 
-    delay(1000); //small delay, initialize everything, voltage on External PSU must settle.
+    delay(CH224Q_BEGIN_SETTLE_MS); //small delay, initialize everything, voltage on External PSU must settle.
                 //1000ms is tested on some PSU's seems to be working on all of them. Any lower vlaue sometimes "crashes" the PSU ant it'll be stuck.
 
     setMode(CH224Q_MODE_5V); //default to 5V Fixed PDO mode
@@ -93,6 +94,17 @@ int8_t CH224Q::readRegister(uint8_t reg, uint8_t &value)
 }
 
 int8_t CH224Q::setMode(uint8_t Mode)
+{
+    int8_t err = requestMode(Mode);
+    if (err != 0)
+        return err; // Return error code if write failed
+
+    delay(CH224Q_MODE_SETTLE_MS); // Small delay to allow mode change to take effect
+
+    return confirmMode(Mode);
+}
+
+int8_t CH224Q::requestMode(uint8_t Mode)
 {
     // Write the mode value to the MODE_CTRL register
 
@@ -100,23 +112,25 @@ int8_t CH224Q::setMode(uint8_t Mode)
 
     if (err != 0)
     {
-        Serial.println("[CH224Q|ERR] CH224Q.setMode() unsuccessfull, I2C Error Code: " + err);
+        CH224Q_LOG(F("[CH224Q|ERR] CH224Q.setMode() unsuccessfull, I2C Error Code: "));
+        CH224Q_LOGLN(err);
         return err; // Return error code if write failed
     }
-        
 
-        
+    return 0;
+}
+
+int8_t CH224Q::confirmMode(uint8_t Mode)
+{
     //datasheet specifies we cant read the CH224Q_VOLTAGEMODE_CTRL register back to confirm mode, so we just look if any Protocoll Handshake has happened 
     //and assume this means the PSU accepted our request
-    delay(100); // Small delay to allow mode change to take effect
-
     uint8_t Mode_Readback = getStatus();
 
     if (Mode_Readback == 0) //if none of the mode bits are set, handshake failed
     {
-        Serial.print("[CH224Q|ERR] CH224Q.setMode() probed register 0x");
-        Serial.print(CH224Q_STATUS, HEX);
-        Serial.println(": could not get a validate handshake from PSU!");
+        CH224Q_LOG(F("[CH224Q|ERR] CH224Q.setMode() probed register 0x"));
+        CH224Q_LOG(CH224Q_STATUS, HEX);
+        CH224Q_LOGLN(F(": could not get a validate handshake from PSU!"));
         CurrentMode = CH224Q_MODE_UNKNOWN; //reset current mode
         return -1; // Handshake failed
     }
@@ -156,15 +170,20 @@ uint8_t CH224Q::getStatus()
     return -1;
 }
 
+uint8_t CH224Q::getMode()
+{
+    return CurrentMode;
+}
+
 uint32_t CH224Q::getPDORawValue(uint8_t index)
 {
 
+#ifdef CH224Q_DEBUG
+
     uint8_t Meta[2] = {0};
     readRegister(CH224Q_SRCCAP_START, Meta[0]);
     readRegister(CH224Q_SRCCAP_START, Meta[1]);
 
-#ifdef CH224Q_DEBUG
-
     Serial.print("PDO Metadata: 0x");
     Serial.print(Meta[0], HEX);
     Serial.print("|0x");
@@ -186,8 +205,8 @@ uint32_t CH224Q::getPDORawValue(uint8_t index)
 
         if (err != 0) {
             // Error reading register, return invalid PDOInfo
-            Serial.print("[CH224Q|ERR] CH224Q.decodePDOInfo(): Error reading PDO Index ");
-            Serial.println(index);
+            CH224Q_LOG(F("[CH224Q|ERR] CH224Q.decodePDOInfo(): Error reading PDO Index "));
+            CH224Q_LOGLN(index);
             return 0;
         }
     }
@@ -231,64 +250,205 @@ int8_t CH224Q::getNumberPDOs()
 
 int8_t CH224Q::requestPPSVoltage_mv(uint16_t voltage_mV)
 {
-    // Check if voltage is within PPS range (3300 to 28000 mV)
-    if (voltage_mV < 3300 || voltage_mV > 28000) {
+    int8_t err = writePPSVoltage_mv(voltage_mV);
+    if (err != 0)
+        return err;
+
+    //if current mode is not PPS mode, switch to PPS mode
+    if (CurrentMode != CH224Q_MODE_PPS) {
+        err = setMode(CH224Q_MODE_PPS);
+        if (err != 0)
+            return err; // Return error code if mode switch failed
+    }
+
+    return 0; // Success
+}
+
+int8_t CH224Q::writePPSVoltage_mv(uint16_t voltage_mV)
+{
+    // Check if voltage is within PPS range (3300 to 21000 mV), the 8 bit register couldn't hold much more anyway
+    if (voltage_mV < 3300 || voltage_mV > 21000) {
         return -1; // Invalid voltage
     }
 
-    // Calculate the register values based on voltage
-    uint16_t rawValue = voltage_mV / 100; // PPS uses 100mV units
+    // Calculate the register values based on voltage, rounded to the nearest step
+    uint8_t rawValue = (voltage_mV + CH224Q_PPS_LSB_MV / 2) / CH224Q_PPS_LSB_MV; // PPS uses 100mV units
 
 
     // Write to PPS voltage control register
     if (writeRegister(CH224Q_PPS_VOLTAGE_CTRL, rawValue) != 0)
         return -1; // Error writing PPS_CTRL
 
+    LastPPSRaw = rawValue;
+    return 0; // Success
+}
 
-    //if current mode is not PPS mode, switch to PPS mode
-    if (CurrentMode != CH224Q_MODE_PPS) {
-        uint8_t err = setMode(CH224Q_MODE_PPS);
+int8_t CH224Q::requestAVSVoltage_mv(uint16_t voltage_mV)
+{
+    int8_t err = writeAVSVoltage_mv(voltage_mV);
+    if (err != 0)
+        return err;
+
+    //if current mode is not AVS mode, switch to AVS mode
+    if (CurrentMode != CH224Q_MODE_AVS) {
+        err = setMode(CH224Q_MODE_AVS);
         if (err != 0)
             return err; // Return error code if mode switch failed
     }
-
     return 0; // Success
 }
 
-int8_t CH224Q::requestAVSVoltage_mv(uint16_t voltage_mV)
+int8_t CH224Q::writeAVSVoltage_mv(uint16_t voltage_mV)
 {
-    // Check if voltage is within AVS range (5000 to 20000 mV)
-    if (voltage_mV < 5000 || voltage_mV > 20000) {
+    // Only the limits of all AVS APDOs are checked here, the range of the actual APDO is checked by setAVSVoltage_mv()
+    if (voltage_mV < CH224Q_AVS_MIN_MV || voltage_mV > CH224Q_AVS_MAX_MV) {
         return -1; // Invalid voltage
     }
 
-    // Calculate the register values based on voltage
-    uint16_t rawValue = voltage_mV / 10; // AVS uses 100mV units
+    // Calculate the register values based on voltage, rounded to the nearest step
+    uint16_t rawValue = (voltage_mV + CH224Q_AVS_LSB_MV / 2) / CH224Q_AVS_LSB_MV; // AVS uses 100mV units
 
     uint8_t highByte = (rawValue >> 8) & 0x7F; // Upper 7 bits
     uint8_t lowByte = rawValue & 0xFF;         // Lower 8 bits
 
     // Set the enable bit in the high byte
-    highByte |= 0x80; // Set highest bit to enable AVS
+    highByte |= CH224Q_AVX_ENABLE; // Set highest bit to enable AVS
 
-    // Write to AVX control registers
-    if (writeRegister(CH224Q_AVX_CTRL1, highByte) != 0)
-        return -1; // Error writing AVX_CTRL1
+    // Write to AVX control registers, lower byte first so the enable bit is written together with the complete value
     if (writeRegister(CH224Q_AVX_CTRL2, lowByte) != 0)
         return -1; // Error writing AVX_CTRL2
+    if (writeRegister(CH224Q_AVX_CTRL1, highByte) != 0)
+        return -1; // Error writing AVX_CTRL1
 
-    //if current mode is not AVS mode, switch to AVS mode
-    if (CurrentMode != CH224Q_MODE_AVS) {
-        uint8_t err = setMode(CH224Q_MODE_AVS);
-        if (err != 0)
-            return err; // Return error code if mode switch failed
-    }
+    LastAVSRaw = rawValue;
     return 0; // Success
 }
 
+#if CH224Q_ENABLE_DECODER
+
+int8_t CH224Q::refreshCapabilities()
+{
+    CapabilitiesValid = false;
+    numAPDORanges = 0;
+
+    int8_t count = getNumberPDOs();
+    if (count <= 0)
+        return -1; // no source capabilities available
+
+    for (uint8_t i = 0; i < count; i++) {
+        PDOInfo pdo = decodePDO(getPDORawValue(i));
+        if (pdo.type != PDOType::Augmented || numAPDORanges >= CH224Q_MAX_APDOS)
+            continue;
+
+        // every APDO keeps its own range, a voltage between two of them would be rejected by the PSU
+        APDORange &r = apdoRanges[numAPDORanges++];
+        r.avs = (pdo.apdo_type != APDO_PPS);
+        r.min_mV = pdo.min_voltage_mV;
+        r.max_mV = pdo.max_voltage_mV;
+    }
+
+    CapabilitiesValid = true;
+    return 0;
+}
+
+int8_t CH224Q::setPPSVoltage_mv(uint16_t voltage_mV, uint16_t &programmed_mV)
+{
+    if (!CapabilitiesValid && refreshCapabilities() != 0)
+        return -1;
+
+    uint16_t rawValue = (voltage_mV + CH224Q_PPS_LSB_MV / 2) / CH224Q_PPS_LSB_MV;
+    uint16_t target_mV = rawValue * CH224Q_PPS_LSB_MV;
+
+    if (!coveredByAPDO(false, target_mV))
+        return -1; // no PPS APDO covers it, the PSU would reject it anyway
+
+    // already requested, nothing to do
+    if (CurrentMode == CH224Q_MODE_PPS && rawValue == LastPPSRaw) {
+        programmed_mV = target_mV;
+        return 0;
+    }
+
+    int8_t err = requestPPSVoltage_mv(target_mV);
+    if (err != 0)
+        return err;
+
+    programmed_mV = target_mV;
+    return 0;
+}
+
+int8_t CH224Q::setAVSVoltage_mv(uint16_t voltage_mV, uint16_t &programmed_mV)
+{
+    if (!CapabilitiesValid && refreshCapabilities() != 0)
+        return -1;
+
+    uint16_t rawValue = (voltage_mV + CH224Q_AVS_LSB_MV / 2) / CH224Q_AVS_LSB_MV;
+    uint16_t target_mV = rawValue * CH224Q_AVS_LSB_MV;
+
+    if (!coveredByAPDO(true, target_mV))
+        return -1; // no AVS APDO covers it, the PSU would reject it anyway
+
+    // already requested, nothing to do
+    if (CurrentMode == CH224Q_MODE_AVS && rawValue == LastAVSRaw) {
+        programmed_mV = target_mV;
+        return 0;
+    }
+
+    int8_t err = requestAVSVoltage_mv(target_mV);
+    if (err != 0)
+        return err;
+
+    programmed_mV = target_mV;
+    return 0;
+}
+
+uint16_t CH224Q::getPPSMinVoltage_mv()
+{
+    return rangeLimit_mV(false, false);
+}
+
+uint16_t CH224Q::getPPSMaxVoltage_mv()
+{
+    return rangeLimit_mV(false, true);
+}
+
+uint16_t CH224Q::getAVSMinVoltage_mv()
+{
+    return rangeLimit_mV(true, false);
+}
+
+uint16_t CH224Q::getAVSMaxVoltage_mv()
+{
+    return rangeLimit_mV(true, true);
+}
+
+bool CH224Q::coveredByAPDO(bool avs, uint16_t voltage_mV)
+{
+    for (uint8_t i = 0; i < numAPDORanges; i++) {
+        if (apdoRanges[i].avs == avs && voltage_mV >= apdoRanges[i].min_mV && voltage_mV <= apdoRanges[i].max_mV)
+            return true;
+    }
+    return false;
+}
+
+uint16_t CH224Q::rangeLimit_mV(bool avs, bool max)
+{
+    uint16_t limit_mV = 0;
+    for (uint8_t i = 0; i < numAPDORanges; i++) {
+        if (apdoRanges[i].avs != avs)
+            continue;
+        uint16_t value_mV = max ? apdoRanges[i].max_mV : apdoRanges[i].min_mV;
+        if (limit_mV == 0 || (max ? value_mV > limit_mV : value_mV < limit_mV))
+            limit_mV = value_mV;
+    }
+    return limit_mV;
+}
+
+#endif // CH224Q_ENABLE_DECODER
+
 uint16_t CH224Q::getMaxCurrent_mA()
 {
-    readRegister(CH224Q_CURRENT_CAPABILTY, (uint8_t&)CurrentMaxCurrentLimit_mA); //read raw value
-    CurrentMaxCurrentLimit_mA = CurrentMaxCurrentLimit_mA * 50; //50mA per LSB 
+    uint8_t rawValue = 0;
+    readRegister(CH224Q_CURRENT_CAPABILTY, rawValue); //read raw value, only 8 bits wide
+    CurrentMaxCurrentLimit_mA = rawValue * 50; //50mA per LSB 
     return CurrentMaxCurrentLimit_mA;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include <Arduino.h>
 #include <Wire.h>
+#include "CH224Q_Config.h"
 #include "CH224Q_Registers.h"
 #include "CH224Q_PDO_Decoder.h"
 
@@ -16,6 +17,18 @@
 
 #define CH224Q_DEFAULT_I2C_ADDRESS 0x22
 
+//Timing constants, can be overridden by build flags (e.g. -DCH224Q_MODE_SETTLE_MS=60) with values measured by examples/CharacteriseSupply
+#ifndef CH224Q_BEGIN_SETTLE_MS
+#define CH224Q_BEGIN_SETTLE_MS 1000 //delay in begin() before the first mode request. Lower values sometimes "crash" the PSU
+#endif
+#ifndef CH224Q_MODE_SETTLE_MS
+#define CH224Q_MODE_SETTLE_MS 100   //delay in setMode() between writing the mode and checking for a handshake
+#endif
+
+#ifndef CH224Q_MAX_APDOS
+#define CH224Q_MAX_APDOS 4 //APDO ranges cached by refreshCapabilities(), voltages of further APDOs are rejected
+#endif
+
 
 
 class CH224Q {
@@ -31,13 +44,39 @@ public:
     int8_t begin(uint8_t address = CH224Q_DEFAULT_I2C_ADDRESS); 
 
     int8_t setMode(uint8_t Mode); //requests either Fixeds PDO or PPS/AVX mode from the PD-Source
+    int8_t requestMode(uint8_t Mode); //only writes the mode register and returns immediately, finish with confirmMode() once the PSU had time to settle
+    int8_t confirmMode(uint8_t Mode); //checks for a handshake after requestMode() and if successful takes over Mode as the current mode
     uint8_t getStatus(); //returns CH224Q_STATUS_REGISTER status bits. Indicate if a protocol handshake was successful and if so which one
+    uint8_t getMode(); //returns the last mode accepted by the PD-Source (CH224Q_MODE_xxx), 0xFF if unknown
 
     int8_t getNumberPDOs(); //how many PDOs are available from the source capabilities. CH224Q can handle up to 12 PDOs
     uint32_t getPDORawValue(uint8_t index); //get raw PDO value at given index (0-based)
 
-    int8_t requestPPSVoltage_mv(uint16_t voltage_mV); //requests the desired PPS voltage in mV (5000 to 28000 mV) from the PD-Source. Will automatically request PPS mode if not already set
-    int8_t requestAVSVoltage_mv(uint16_t voltage_mV); //requests the desired AVS voltage in mV (5000 to 20000 mV) from the PD-Source. Will automatically request AVS mode if not already set
+    int8_t requestPPSVoltage_mv(uint16_t voltage_mV); //requests the desired PPS voltage in mV (3300 to 21000 mV) from the PD-Source. Will automatically request PPS mode if not already set
+    int8_t requestAVSVoltage_mv(uint16_t voltage_mV); //requests the desired AVS voltage in mV (9000 to 28000 mV, the APDO decides what is accepted) from the PD-Source. Will automatically request AVS mode if not already set
+    int8_t writePPSVoltage_mv(uint16_t voltage_mV); //only writes the PPS voltage register, does not switch to PPS mode
+    int8_t writeAVSVoltage_mv(uint16_t voltage_mV); //only writes the AVS voltage registers, does not switch to AVS mode
+
+#if CH224Q_ENABLE_DECODER
+    /**
+     * Reads and decodes the source capabilities once and caches the voltage range of every APDO (up to CH224Q_MAX_APDOS).
+     * Called automatically by the first setPPSVoltage_mv()/setAVSVoltage_mv(), call it again if the PSU changed.
+     **/
+    int8_t refreshCapabilities();
+
+    /**
+     * Rounds voltage_mV to the nearest step of the voltage register and checks that one APDO of the kind covers it,
+     * so requests the PSU would reject fail without any I2C traffic. Nothing is written if the same voltage is already set.
+     * On success programmed_mV contains the voltage actually requested from the PSU.
+     **/
+    int8_t setPPSVoltage_mv(uint16_t voltage_mV, uint16_t &programmed_mV);
+    int8_t setAVSVoltage_mv(uint16_t voltage_mV, uint16_t &programmed_mV);
+
+    uint16_t getPPSMinVoltage_mv(); //lowest min and highest max of all PPS APDOs (there may be gaps), 0 if there are none or refreshCapabilities() wasn't called yet
+    uint16_t getPPSMaxVoltage_mv();
+    uint16_t getAVSMinVoltage_mv(); //same for all AVS APDOs (SPR and EPR)
+    uint16_t getAVSMaxVoltage_mv();
+#endif
 
 
     uint16_t getMaxCurrent_mA(); //get currently set max current in mA. Might be invalid if chip operates in QC/BC mode
@@ -56,4 +95,22 @@ private:
 
     uint16_t CurrentMaxCurrentLimit_mA = 0; //currently set current limit in mA (0 if not set). Might be invalid if chip operates in QC/BC mode
 
+    uint8_t LastPPSRaw = 0; //last value written to CH224Q_PPS_VOLTAGE_CTRL (0 if none)
+    uint16_t LastAVSRaw = 0; //last value written to CH224Q_AVX_CTRL1/2 without enable Bit (0 if none)
+
+#if CH224Q_ENABLE_DECODER
+    bool coveredByAPDO(bool avs, uint16_t voltage_mV); //true if a cached APDO of the kind contains voltage_mV
+    uint16_t rangeLimit_mV(bool avs, bool max);        //lowest min or highest max of the cached APDOs of the kind
+#endif
+
+    struct APDORange {
+        bool avs;        //false: PPS APDO, true: SPR or EPR AVS APDO
+        uint16_t min_mV;
+        uint16_t max_mV;
+    };
+
+    bool CapabilitiesValid = false; //set by refreshCapabilities(), so the layout doesn't depend on CH224Q_ENABLE_DECODER
+    APDORange apdoRanges[CH224Q_MAX_APDOS];
+    uint8_t numAPDORanges = 0;
+
 };
\ No newline at end of file
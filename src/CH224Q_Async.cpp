@@ -0,0 +1,161 @@
+#include "CH224Q_Async.h"
+
+#ifdef CH224Q_HAS_COROUTINES
+
+
+void CH224Q_Scheduler::spawn(CH224Q_Task&& task)
+{
+    std::coroutine_handle<CH224Q_Task::promise_type> h = task.handle;
+    if (!h || h.done())
+        return;
+
+    task.handle = nullptr; //task object no longer owns the frame
+    h.promise().detached = true;
+    h.resume(); //runs until the first co_await which has to wait
+}
+
+int8_t CH224Q_Scheduler::runUntilDone(CH224Q_Task& task, uint32_t timeout_ms)
+{
+    if (!task.handle)
+        return -1;
+
+    //a started task is parked in the scheduler (or awaits one that is), resuming it here would skip its wait
+    uint32_t start = millis();
+    if (!task.handle.promise().started)
+        task.handle.resume();
+
+    while (!task.done()) {
+        if ((millis() - start) >= timeout_ms)
+            return -1;
+        poll();
+        yield();
+    }
+    return task.result();
+}
+
+bool CH224Q_Scheduler::addWaiter(std::coroutine_handle<> h, Awaiter* awaiter)
+{
+    for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS; i++) {
+        if (waiters[i].handle)
+            continue;
+        waiters[i].handle = h;
+        waiters[i].awaiter = awaiter;
+        waiters[i].start_ms = millis();
+        awaiter->queued = true;
+        return true;
+    }
+
+#ifdef CH224Q_DEBUG
+    Serial.println("[CH224Q|Info] CH224Q_Scheduler: no free waiter slot, increase CH224Q_ASYNC_MAX_WAITERS");
+#endif
+    return false;
+}
+
+void CH224Q_Scheduler::removeWaiter(Awaiter* awaiter)
+{
+    for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS; i++) {
+        if (waiters[i].handle && waiters[i].awaiter == awaiter) {
+            waiters[i].handle = nullptr;
+            waiters[i].awaiter = nullptr;
+        }
+    }
+    awaiter->queued = false;
+}
+
+void CH224Q_Scheduler::poll()
+{
+    uint32_t now = millis();
+
+    bool readStatus = (now - lastStatusPoll_ms) >= CH224Q_ASYNC_STATUS_POLL_MS;
+    if (readStatus)
+        lastStatusPoll_ms = now;
+
+    for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS; i++) {
+        Waiter& w = waiters[i];
+        if (!w.handle)
+            continue;
+
+        Awaiter* a = w.awaiter;
+        bool expired = (now - w.start_ms) >= a->timeout_ms;
+        int8_t result = 0;
+
+        if (a->ch) {
+            if (readStatus && (a->ch->getStatus() != a->status || a->ch->getMaxCurrent_mA() != a->current_mA))
+                result = 0; //new contract in place
+            else if (expired)
+                result = -1; //no handshake within timeout
+            else
+                continue;
+        }
+        else if (!expired) {
+            continue;
+        }
+
+        //free the slot before resuming, the coroutine may immediately wait again
+        std::coroutine_handle<> h = w.handle;
+        a->result = result;
+        a->queued = false;
+        w.handle = nullptr;
+        w.awaiter = nullptr;
+        h.resume();
+    }
+}
+
+bool CH224Q_Scheduler::idle() const
+{
+    for (uint8_t i = 0; i < CH224Q_ASYNC_MAX_WAITERS; i++) {
+        if (waiters[i].handle)
+            return false;
+    }
+    return true;
+}
+
+
+CH224Q_Async::CH224Q_Async(CH224Q* _ch, CH224Q_Scheduler* _sched)
+{
+    ch = _ch;
+    sched = _sched;
+}
+
+CH224Q_Task CH224Q_Async::setMode(uint8_t Mode)
+{
+    uint8_t status = ch->getStatus();
+    uint16_t current_mA = ch->getMaxCurrent_mA();
+
+    int8_t err = ch->requestMode(Mode);
+    if (err != 0)
+        co_return err;
+
+    co_await sched->sleep_ms(CH224Q_MODE_SETTLE_MS); //same settle time as the blocking setMode()
+    co_await sched->waitHandshake(ch, status, current_mA, CH224Q_ASYNC_HANDSHAKE_TIMEOUT_MS); //slow PSUs take longer
+
+    co_return ch->confirmMode(Mode);
+}
+
+CH224Q_Task CH224Q_Async::requestPPS(uint16_t voltage_mV)
+{
+    int8_t err = ch->writePPSVoltage_mv(voltage_mV);
+    if (err != 0)
+        co_return err;
+
+    //if current mode is not PPS mode, switch to PPS mode
+    if (ch->getMode() != CH224Q_MODE_PPS)
+        co_return co_await setMode(CH224Q_MODE_PPS);
+
+    co_return 0;
+}
+
+CH224Q_Task CH224Q_Async::requestAVS(uint16_t voltage_mV)
+{
+    int8_t err = ch->writeAVSVoltage_mv(voltage_mV);
+    if (err != 0)
+        co_return err;
+
+    //if current mode is not AVS mode, switch to AVS mode
+    if (ch->getMode() != CH224Q_MODE_AVS)
+        co_return co_await setMode(CH224Q_MODE_AVS);
+
+    co_return 0;
+}
+
+#endif // CH224Q_HAS_COROUTINES
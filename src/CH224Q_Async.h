@@ -0,0 +1,208 @@
+/*
+    CH224Q_Async.h - Optional C++20 coroutine layer for CH224Q negotiation
+    Lets negotiation sequences be written as straight code instead of blocking calls or hand-written state machines:
+
+        CH224Q_Task negotiate(CH224Q_Async& dev) {
+            if (co_await dev.setMode(CH224Q_MODE_PPS) != 0) co_return -1;
+            co_return co_await dev.requestPPS(9000);
+        }
+
+    A single-threaded CH224Q_Scheduler resumes the coroutines on timer expiry or once the status or current register
+    of their device shows a new contract, so many devices can be driven from loop() without a stack per task.
+    Only available if the compiler supports coroutines (-std=c++20) and CH224Q_ENABLE_ASYNC is set, otherwise this header is empty.
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include "CH224Q_Config.h"
+
+#if CH224Q_ENABLE_ASYNC && defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define CH224Q_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef CH224Q_HAS_COROUTINES
+
+#include <Arduino.h>
+#include <coroutine>
+#include "CH224Q_Arduino.h"
+
+#ifndef CH224Q_ASYNC_MAX_WAITERS
+#define CH224Q_ASYNC_MAX_WAITERS 8              //coroutines which can be suspended at the same time (one per concurrently negotiated device is enough)
+#endif
+#ifndef CH224Q_ASYNC_STATUS_POLL_MS
+#define CH224Q_ASYNC_STATUS_POLL_MS 5           //how often the status register of waiting devices is read, keeps the I2C bus free in between
+#endif
+#ifndef CH224Q_ASYNC_HANDSHAKE_TIMEOUT_MS
+#define CH224Q_ASYNC_HANDSHAKE_TIMEOUT_MS 1000  //how long setMode() waits for the new contract after CH224Q_MODE_SETTLE_MS
+#endif
+
+
+/**
+ * Coroutine returning an int8_t result (0 = success, same codes as the CH224Q class).
+ * Lazily started: either co_await it from another CH224Q_Task or hand it to CH224Q_Scheduler::spawn().
+ **/
+class CH224Q_Task {
+public:
+
+    struct promise_type {
+        int8_t result = 0;
+        bool started = false;  //body runs or ran, from now on only the scheduler or an awaited task resumes it
+        bool detached = false; //frame is owned by nobody and destroys itself when finished
+        std::coroutine_handle<> continuation = nullptr;
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                promise_type& p = h.promise();
+                if (p.continuation)
+                    return p.continuation; //resume whoever awaited us
+                if (p.detached)
+                    h.destroy();
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+
+        struct InitialAwaiter {
+            promise_type* p;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<>) noexcept {}
+            void await_resume() noexcept { p->started = true; }
+        };
+
+        CH224Q_Task get_return_object() { return CH224Q_Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        InitialAwaiter initial_suspend() noexcept { return {this}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_value(int8_t value) { result = value; }
+        void unhandled_exception() {}
+    };
+
+    CH224Q_Task(CH224Q_Task&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    CH224Q_Task(const CH224Q_Task&) = delete;
+    CH224Q_Task& operator=(const CH224Q_Task&) = delete;
+    ~CH224Q_Task() { if (handle) handle.destroy(); }
+
+    bool done() const { return !handle || handle.done(); }
+    int8_t result() const { return handle ? handle.promise().result : -1; }
+
+    //awaiting a task starts it and resumes the awaiting coroutine once it finished
+    bool await_ready() const { return done(); }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting)
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    int8_t await_resume() const { return result(); }
+
+private:
+
+    friend class CH224Q_Scheduler;
+
+    explicit CH224Q_Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+    std::coroutine_handle<promise_type> handle;
+
+};
+
+
+class CH224Q_Scheduler {
+public:
+
+    //result of co_await on sleep_ms()/waitHandshake(): 0 on success, -1 on timeout or if no waiter slot was free
+    class Awaiter {
+    public:
+        Awaiter(CH224Q_Scheduler* _sched, CH224Q* _ch, uint32_t _timeout_ms, uint8_t _status = 0, uint16_t _current_mA = 0)
+            : sched(_sched), ch(_ch), timeout_ms(_timeout_ms), status(_status), current_mA(_current_mA) {}
+        Awaiter(const Awaiter&) = delete;
+        Awaiter& operator=(const Awaiter&) = delete;
+        //lives in the coroutine frame, so this runs if the frame is destroyed while suspended (e.g. task went out of scope)
+        ~Awaiter() { if (queued) sched->removeWaiter(this); }
+
+        bool await_ready() const { return !ch && timeout_ms == 0; }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            if (sched->addWaiter(h, this))
+                return true;
+            result = -1; //table full, continue right away with an error
+            return false;
+        }
+        int8_t await_resume() const { return result; }
+    private:
+        friend class CH224Q_Scheduler;
+        CH224Q_Scheduler* sched;
+        CH224Q* ch;
+        uint32_t timeout_ms;
+        uint8_t status;      //getStatus() and getMaxCurrent_mA() before the request, a change means the new contract is in place
+        uint16_t current_mA;
+        int8_t result = 0;
+        bool queued = false; //occupies a waiter slot
+    };
+
+    /**
+     * Starts a task and lets it run in the background. The scheduler does not keep track of the task itself,
+     * its frame is freed as soon as it finishes. Keep the CH224Q_Task instead if you need the result.
+     **/
+    void spawn(CH224Q_Task&& task);
+
+    /**
+     * Runs a task until it is finished (or timeout_ms expired) by calling poll() in a loop.
+     * On timeout the task stays suspended and can be run again (it continues where it waits), destroying it cancels it.
+     * Mainly useful to drive tasks from setup() or from host tests.
+     **/
+    int8_t runUntilDone(CH224Q_Task& task, uint32_t timeout_ms);
+
+    void poll(); //Call this as often as possible from loop(), resumes all coroutines whose timer expired or whose device got a new contract
+    bool idle() const; //true if no coroutine is waiting
+
+    Awaiter sleep_ms(uint32_t ms) { return Awaiter(this, nullptr, ms); }
+    /**
+     * Waits until getStatus() or getMaxCurrent_mA() of ch differ from the values read before the request.
+     * The status bits alone keep showing the previous contract. A new contract with the same protocol and
+     * current can't be told apart from the old one, then this ends with -1 after timeout_ms.
+     **/
+    Awaiter waitHandshake(CH224Q* ch, uint8_t status, uint16_t current_mA, uint32_t timeout_ms) { return Awaiter(this, ch, timeout_ms, status, current_mA); }
+
+private:
+
+    struct Waiter {
+        std::coroutine_handle<> handle = nullptr; //nullptr = slot is free
+        Awaiter* awaiter = nullptr;               //receives the result, ch == nullptr: plain timer, otherwise wait for a new contract
+        uint32_t start_ms = 0;
+    };
+
+    bool addWaiter(std::coroutine_handle<> h, Awaiter* awaiter);
+    void removeWaiter(Awaiter* awaiter); //frees the slot of a destroyed coroutine, it must never be resumed
+
+    Waiter waiters[CH224Q_ASYNC_MAX_WAITERS];
+    uint32_t lastStatusPoll_ms = 0;
+
+};
+
+
+/**
+ * Coroutine versions of the negotiation calls of one CH224Q.
+ * The device must have been initialised with begin() before.
+ **/
+class CH224Q_Async {
+public:
+
+    CH224Q_Async(CH224Q* _ch, CH224Q_Scheduler* _sched); //Constructor
+
+    CH224Q_Task setMode(uint8_t Mode); //same as CH224Q::setMode() without blocking
+    CH224Q_Task requestPPS(uint16_t voltage_mV); //same as CH224Q::requestPPSVoltage_mv() without blocking
+    CH224Q_Task requestAVS(uint16_t voltage_mV); //same as CH224Q::requestAVSVoltage_mv() without blocking
+
+    CH224Q* device() { return ch; } //for the non-blocking calls (getStatus(), getMaxCurrent_mA(), ...)
+
+private:
+
+    CH224Q* ch;
+    CH224Q_Scheduler* sched;
+
+};
+
+#endif // CH224Q_HAS_COROUTINES
@@ -0,0 +1,40 @@
+/*
+    CH224Q_Config.h - Compile-time feature switches of the CH224Q library
+    All features are enabled by default. On small targets (ATtiny/AVR) switch off what is not needed
+    via build flags, e.g. in platformio.ini:
+        build_flags = -DCH224Q_ENABLE_LOGGING=0 -DCH224Q_ENABLE_FORMATTING=0
+    A disabled feature removes its functions from the API, so accidental use fails at compile time.
+    extras/size-report builds every configuration and checks its flash/RAM budget.
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#ifndef CH224Q_ENABLE_DECODER
+#define CH224Q_ENABLE_DECODER 1     //decodePDO() and everything working on decoded PDOs
+#endif
+
+#ifndef CH224Q_ENABLE_FORMATTING
+#define CH224Q_ENABLE_FORMATTING CH224Q_ENABLE_DECODER  //PDO2String(), pulls in String and float formatting. Needs CH224Q_ENABLE_DECODER
+#endif
+
+#ifndef CH224Q_ENABLE_LOGGING
+#define CH224Q_ENABLE_LOGGING 1     //error messages on Serial, pulls in Serial even if the sketch doesn't use it
+#endif
+
+#ifndef CH224Q_ENABLE_ASYNC
+#define CH224Q_ENABLE_ASYNC 1       //coroutine layer (CH224Q_Async.h), only built if the compiler supports coroutines anyway
+#endif
+
+#if CH224Q_ENABLE_FORMATTING && !CH224Q_ENABLE_DECODER
+#error "CH224Q_ENABLE_FORMATTING needs CH224Q_ENABLE_DECODER"
+#endif
+
+//error messages, literals should be wrapped in F() to keep them out of RAM on AVR
+#if CH224Q_ENABLE_LOGGING
+#define CH224Q_LOG(...)     Serial.print(__VA_ARGS__)
+#define CH224Q_LOGLN(...)   Serial.println(__VA_ARGS__)
+#else
+#define CH224Q_LOG(...)
+#define CH224Q_LOGLN(...)
+#endif
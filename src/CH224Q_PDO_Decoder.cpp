@@ -1,5 +1,7 @@
 #include "CH224Q_PDO_Decoder.h"
 
+#if CH224Q_ENABLE_DECODER
+
 PDOInfo decodePDO(uint32_t pdoRawValue) {
     PDOInfo info;
 
@@ -38,12 +40,34 @@ PDOInfo decodePDO(uint32_t pdoRawValue) {
             info.max_current_mA = (pdoRawValue & 0x3FFu) * 10u;         // Current[9:0]=10bits (10mA)
             break;
 
-        case 3: // Augmented / APDO (PPS)
+        case 3: // Augmented / APDO (PPS or AVS)
             info.type = PDOType::Augmented;
-            // APDO uses different widths: Vmax[24:17]=8bits (100mV), Vmin[15:8]=8bits (100mV), I[6:0]=7bits (50mA)
-            info.max_voltage_mV = ((pdoRawValue >> 17) & 0xFFu) * 100u; // 100 mV units
-            info.min_voltage_mV = ((pdoRawValue >> 8) & 0xFFu) * 100u;  // 100 mV units
-            info.max_current_mA = (pdoRawValue & 0x7Fu) * 50u;          // 50 mA units
+            switch ((pdoRawValue >> 28) & 0x3u) {
+                case 0: // SPR PPS
+                    // APDO uses different widths: Vmax[24:17]=8bits (100mV), Vmin[15:8]=8bits (100mV), I[6:0]=7bits (50mA)
+                    info.apdo_type = APDO_PPS;
+                    info.max_voltage_mV = ((pdoRawValue >> 17) & 0xFFu) * 100u; // 100 mV units
+                    info.min_voltage_mV = ((pdoRawValue >> 8) & 0xFFu) * 100u;  // 100 mV units
+                    info.max_current_mA = (pdoRawValue & 0x7Fu) * 50u;          // 50 mA units
+                    break;
+                case 1: // EPR AVS
+                    // Vmax[25:17]=9bits (100mV), Vmin[15:8]=8bits (100mV), PDP[7:0]=8bits (1W)
+                    info.apdo_type = APDO_EPR_AVS;
+                    info.max_voltage_mV = ((pdoRawValue >> 17) & 0x1FFu) * 100u;
+                    info.min_voltage_mV = ((pdoRawValue >> 8) & 0xFFu) * 100u;
+                    info.max_power_mW = (pdoRawValue & 0xFFu) * 1000u;
+                    break;
+                case 2: // SPR AVS
+                    // fixed range 9V to 20V, I(9-15V)[19:10]=10bits (10mA), I(15-20V)[9:0]=10bits (10mA)
+                    info.apdo_type = APDO_SPR_AVS;
+                    info.min_voltage_mV = 9000;
+                    info.max_voltage_mV = 20000;
+                    info.max_current_mA = ((pdoRawValue >> 10) & 0x3FFu) * 10u; // current up to 15V, above 15V it's limited to bits [9:0]
+                    break;
+                default: // reserved
+                    info.type = PDOType::Unknown;
+                    break;
+            }
             break;
 
         default:
@@ -53,6 +77,8 @@ PDOInfo decodePDO(uint32_t pdoRawValue) {
     return info;
 }
 
+#if CH224Q_ENABLE_FORMATTING
+
 void PDO2String(PDOInfo pdo, String* str)
 {
     if (!pdo.valid()) {
@@ -71,10 +97,17 @@ void PDO2String(PDOInfo pdo, String* str)
             *str = "Battery PDO: " + String(pdo.max_power_mW/1000.0f) + "W from " + String(pdo.min_voltage_mV/1000.0f) + "V to " + String(pdo.max_voltage_mV/1000.0f) + "V";
             break;
         case PDOType::Augmented:
-            *str = "Augmented PDO (PPS): " + String(pdo.max_current_mA/1000.0f) + "A from " + String(pdo.min_voltage_mV/1000.0f) + "V to " + String(pdo.max_voltage_mV/1000.0f) + "V";
+            if (pdo.apdo_type == APDO_EPR_AVS)
+                *str = "Augmented PDO (EPR AVS): " + String(pdo.max_power_mW/1000.0f) + "W from " + String(pdo.min_voltage_mV/1000.0f) + "V to " + String(pdo.max_voltage_mV/1000.0f) + "V";
+            else
+                *str = String(pdo.apdo_type == APDO_SPR_AVS ? "Augmented PDO (SPR AVS): " : "Augmented PDO (PPS): ") + String(pdo.max_current_mA/1000.0f) + "A from " + String(pdo.min_voltage_mV/1000.0f) + "V to " + String(pdo.max_voltage_mV/1000.0f) + "V";
             break;
         default:
             *str = "Unknown PDO Type";
             break;
     }
-}
\ No newline at end of file
+}
+
+#endif // CH224Q_ENABLE_FORMATTING
+
+#endif // CH224Q_ENABLE_DECODER
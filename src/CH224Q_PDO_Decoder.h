@@ -5,7 +5,10 @@
  * 
  * Notes (common encodings used here):
  *  - PDO Type: bits 31..30 (0 = Fixed, 1 = Battery, 2 = Variable, 3 = Augmented/APDO (PPS))
+ *  - APDO Type: bits 29..28 (0 = SPR PPS, 1 = EPR AVS, 2 = SPR AVS)
  *
+ * decodePDO() doesn't need the Arduino core, only PDO2String() does. With CH224Q_ENABLE_FORMATTING=0
+ * this header and CH224Q_PDO_Decoder.cpp build anywhere, extras/host/ch224q_ctl.cpp uses them that way.
  * 
  * License: MIT 4R3N(cad435) 2025-12-13
  * 
@@ -17,9 +20,14 @@
 #ifndef CH224Q_PDO_DECODER_H
 #define CH224Q_PDO_DECODER_H
 
-#include <Arduino.h>
+#include <stdint.h>
+#include "CH224Q_Config.h"
 
-#include <cstdint>
+#if CH224Q_ENABLE_FORMATTING
+#include <Arduino.h> //String
+#endif
+
+#if CH224Q_ENABLE_DECODER
 
 enum PDOType{
         Fixed     = 0,
@@ -29,9 +37,17 @@ enum PDOType{
         Unknown   = 0xFF
     };
 
+enum APDOType{
+        APDO_PPS     = 0, // SPR Programmable Power Supply
+        APDO_EPR_AVS = 1, // EPR Adjustable Voltage Supply
+        APDO_SPR_AVS = 2, // SPR Adjustable Voltage Supply (9V to 20V)
+        APDO_NONE    = 0xFF // not an APDO
+    };
+
 struct PDOInfo {
     uint32_t raw = 0;             // original 32-bit PDO value
     PDOType  type = PDOType::Unknown;
+    APDOType apdo_type = APDO_NONE; // only set for Augmented PDOs
 
     // For fixed: voltage_mV = nominal =  min = max.
     // For variable/battery/APDO: min/max valid if set (0 if unused).
@@ -40,13 +56,17 @@ struct PDOInfo {
 
     // Current fields (max/current depending on type). 0 if unused.
     uint32_t max_current_mA = 0;      // max current for fixed/variable/APDO
-    uint32_t max_power_mW = 0;    // for battery PDO (max power)
+    uint32_t max_power_mW = 0;    // for battery PDO (max power) and EPR AVS APDO (PDP)
 
     bool valid() const { return type != PDOType::Unknown; }
 };
     // Decode a single 32-bit PDO into PDOInfo.
     PDOInfo decodePDO(uint32_t pdo);
+#if CH224Q_ENABLE_FORMATTING
     void PDO2String(PDOInfo pdo, String*); //convert PDOInfo to human-readable string
+#endif
+
+#endif // CH224Q_ENABLE_DECODER
 
 
 #endif // CH224Q_PDO_DECODER_H
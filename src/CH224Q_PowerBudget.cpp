@@ -0,0 +1,265 @@
+#include "CH224Q_PowerBudget.h"
+
+#if CH224Q_ENABLE_DECODER
+
+//voltages of the fixed modes, indexed by CH224Q_MODE_5V..CH224Q_MODE_28V
+static const uint16_t fixedVoltages_mV[6] = {5000, 9000, 12000, 15000, 20000, 28000};
+
+
+CH224Q_PowerBudget::CH224Q_PowerBudget(uint32_t totalBudget_mW)
+{
+    budget_mW = totalBudget_mW;
+}
+
+int8_t CH224Q_PowerBudget::addPort(CH224Q* ch, uint8_t priority)
+{
+    if (!ch || numPorts >= CH224Q_BUDGET_MAX_PORTS)
+        return -1;
+
+    uint8_t port = numPorts++;
+    ports[port].ch = ch;
+    ports[port].priority = priority;
+    refreshPort(port);
+
+    return port;
+}
+
+int8_t CH224Q_PowerBudget::refreshPort(uint8_t port)
+{
+    if (port >= numPorts)
+        return -1;
+
+    Port& p = ports[port];
+    for (uint8_t m = 0; m < 6; m++)
+        p.fixedCurrent_mA[m] = 0;
+    p.numPPS = 0;
+
+    p.ch->refreshCapabilities(); //caches the PPS range checked by setPPSVoltage_mv()
+
+    int8_t count = p.ch->getNumberPDOs();
+    for (uint8_t i = 0; i < count; i++) {
+        PDOInfo pdo = decodePDO(p.ch->getPDORawValue(i));
+
+        if (pdo.type == PDOType::Fixed) {
+            for (uint8_t m = 0; m < 6; m++) {
+                if (fixedVoltages_mV[m] == pdo.min_voltage_mV)
+                    p.fixedCurrent_mA[m] = pdo.max_current_mA;
+            }
+        }
+        else if (pdo.type == PDOType::Augmented && pdo.apdo_type == APDO_PPS && p.numPPS < CH224Q_BUDGET_MAX_PPS) {
+            p.pps[p.numPPS].min_mV = pdo.min_voltage_mV;
+            p.pps[p.numPPS].max_mV = pdo.max_voltage_mV;
+            p.pps[p.numPPS].current_mA = pdo.max_current_mA;
+            p.numPPS++;
+        }
+    }
+
+    return (count > 0) ? 0 : -1;
+}
+
+void CH224Q_PowerBudget::setTotalBudget_mW(uint32_t totalBudget_mW)
+{
+    budget_mW = totalBudget_mW;
+}
+
+int8_t CH224Q_PowerBudget::setPriority(uint8_t port, uint8_t priority)
+{
+    if (port >= numPorts)
+        return -1;
+
+    ports[port].priority = priority;
+    return 0;
+}
+
+int8_t CH224Q_PowerBudget::setDemand(uint8_t port, uint16_t voltage_mV, uint16_t current_mA)
+{
+    if (port >= numPorts)
+        return -1;
+
+    ports[port].demandVoltage_mV = voltage_mV;
+    ports[port].demandCurrent_mA = current_mA;
+    return 0;
+}
+
+bool CH224Q_PowerBudget::planContract(const Port& p, uint16_t voltage_mV, CH224Q_PortContract& c)
+{
+    uint16_t current_mA = (p.demandVoltage_mV != 0) ? p.demandCurrent_mA : 0; //idle ports don't need any power
+    uint16_t cap_mA = 0;
+
+    c = CH224Q_PortContract();
+
+    // prefer a fixed PDO
+    for (uint8_t m = 0; m < 6; m++) {
+        if (fixedVoltages_mV[m] != voltage_mV)
+            continue;
+
+        cap_mA = p.fixedCurrent_mA[m];
+        if (cap_mA == 0 && m == CH224Q_MODE_5V)
+            cap_mA = current_mA; // 5V is always there, even without (readable) source capabilities
+        if (cap_mA != 0 || m == CH224Q_MODE_5V) {
+            c.mode = m;
+            c.voltage_mV = voltage_mV;
+        }
+        break;
+    }
+
+    // otherwise PPS, with the current of the APDO covering the voltage
+    if (c.mode == (uint8_t)CH224Q_MODE_UNKNOWN) {
+        uint16_t rounded_mV = (voltage_mV + CH224Q_PPS_LSB_MV / 2) / CH224Q_PPS_LSB_MV * CH224Q_PPS_LSB_MV;
+        for (uint8_t i = 0; i < p.numPPS; i++) {
+            if (rounded_mV < p.pps[i].min_mV || rounded_mV > p.pps[i].max_mV)
+                continue;
+            if (cap_mA == 0 || p.pps[i].current_mA < cap_mA)
+                cap_mA = p.pps[i].current_mA; // overlapping APDOs: plan with the lowest current, the contract might use any of them
+        }
+        if (cap_mA == 0)
+            return false;
+
+        c.mode = CH224Q_MODE_PPS;
+        c.voltage_mV = rounded_mV;
+    }
+
+    c.current_mA = (current_mA < cap_mA) ? current_mA : cap_mA;
+    c.power_mW = (uint32_t)c.voltage_mV * c.current_mA / 1000;
+    return true;
+}
+
+int8_t CH224Q_PowerBudget::applyContract(Port& p, const CH224Q_PortContract& c)
+{
+    p.previousCurrent_mA = p.ch->getMaxCurrent_mA();
+    p.currentPending = true;
+
+    int8_t err;
+    if (c.mode == CH224Q_MODE_PPS) {
+        uint16_t programmed_mV = 0;
+        err = p.ch->setPPSVoltage_mv(c.voltage_mV, programmed_mV);
+    }
+    else {
+        err = p.ch->setMode(c.mode);
+    }
+
+    if (err != 0) {
+        p.applied = CH224Q_PortContract(); // unknown state, renegotiate on the next rebalance()
+        return -1;
+    }
+
+    p.applied = c;
+    return 0;
+}
+
+void CH224Q_PowerBudget::limitToContract(Port& p)
+{
+    uint16_t actual_mA = p.ch->getMaxCurrent_mA();
+
+    // the handshake may still be running when setMode() returns, checked again on the next rebalance()
+    if (p.currentPending && actual_mA == p.previousCurrent_mA)
+        return;
+    p.currentPending = false;
+
+    // the contract may offer less than the source capabilities promised
+    if (actual_mA != 0 && actual_mA < p.applied.current_mA) {
+        p.applied.current_mA = actual_mA;
+        p.applied.power_mW = (uint32_t)p.applied.voltage_mV * actual_mA / 1000;
+    }
+}
+
+int8_t CH224Q_PowerBudget::rebalance()
+{
+    CH224Q_PortContract planned[CH224Q_BUDGET_MAX_PORTS];
+    uint32_t remaining_mW = budget_mW;
+    int8_t result = 0;
+
+    // every port draws at least its demand at 5V
+    for (uint8_t i = 0; i < numPorts; i++) {
+        if (!planContract(ports[i], 5000, planned[i]))
+            continue; // can't happen, 5V is always planned. planned[i] stays unknown and the port is left alone
+
+        if (planned[i].power_mW > remaining_mW) {
+            result = -2;
+            remaining_mW = 0;
+        }
+        else {
+            remaining_mW -= planned[i].power_mW;
+        }
+    }
+
+    // port indices sorted by priority, highest first, same priority keeps the order of addPort()
+    uint8_t order[CH224Q_BUDGET_MAX_PORTS];
+    for (uint8_t i = 0; i < numPorts; i++) {
+        uint8_t j = i;
+        while (j > 0 && ports[order[j - 1]].priority < ports[i].priority) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    // raise ports to their demanded voltage as long as the budget allows
+    for (uint8_t k = 0; k < numPorts; k++) {
+        uint8_t i = order[k];
+        if (ports[i].demandVoltage_mV == 0 || ports[i].demandVoltage_mV == 5000)
+            continue;
+
+        CH224Q_PortContract c;
+        if (!planContract(ports[i], ports[i].demandVoltage_mV, c))
+            continue; // voltage not offered by this PSU, stays at 5V
+
+        if (c.power_mW <= remaining_mW + planned[i].power_mW) {
+            remaining_mW = remaining_mW + planned[i].power_mW - c.power_mW;
+            planned[i] = c;
+        }
+    }
+
+    // apply, first everything that lowers its power, then the rest
+    renegotiations = 0;
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint8_t i = 0; i < numPorts; i++) {
+            Port& p = ports[i];
+            bool lowering = planned[i].power_mW < p.applied.power_mW;
+            if ((pass == 0) != lowering || planned[i].mode == (uint8_t)CH224Q_MODE_UNKNOWN)
+                continue;
+
+            if (p.applied.mode != (uint8_t)CH224Q_MODE_UNKNOWN && p.applied.mode == planned[i].mode && p.applied.voltage_mV == planned[i].voltage_mV) {
+                p.applied = planned[i]; // same contract, at most the granted current changed
+            }
+            else {
+                renegotiations++;
+                if (applyContract(p, planned[i]) != 0) {
+                    result = -1;
+                    continue;
+                }
+            }
+
+            limitToContract(p);
+        }
+
+        // a port still drawing more than planned leaves no room to raise the others
+        if (result == -1)
+            break;
+    }
+
+    return result;
+}
+
+const CH224Q_PortContract* CH224Q_PowerBudget::getContract(uint8_t port)
+{
+    if (port >= numPorts)
+        return nullptr;
+
+    return &ports[port].applied;
+}
+
+uint32_t CH224Q_PowerBudget::getAllocated_mW()
+{
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < numPorts; i++)
+        sum += ports[i].applied.power_mW;
+    return sum;
+}
+
+uint8_t CH224Q_PowerBudget::getRenegotiations()
+{
+    return renegotiations;
+}
+
+#endif // CH224Q_ENABLE_DECODER
@@ -0,0 +1,99 @@
+/*
+    CH224Q_PowerBudget.h - Power-budget scheduler for several CH224Q sinks sharing one upstream supply
+    Takes a total power budget plus a priority and a demand (voltage, current) per port and assigns the contracts:
+     - every port is guaranteed its demand at 5V (a CH224Q can't switch VBUS off, so 5V is always drawn)
+     - in order of priority, ports are raised to their demanded voltage as long as the budget allows
+     - ports whose demanded voltage is neither a fixed PDO nor within the PPS range stay at 5V
+    rebalance() only renegotiates ports whose contract changed, lowering contracts before raising others,
+    so the sum of all contracts stays within the budget during the transition as well. If lowering a port
+    fails, no port is raised.
+    Needs CH224Q_ENABLE_DECODER.
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "CH224Q_Arduino.h"
+
+#if CH224Q_ENABLE_DECODER
+
+#ifndef CH224Q_BUDGET_MAX_PORTS
+#define CH224Q_BUDGET_MAX_PORTS 4
+#endif
+
+#ifndef CH224Q_BUDGET_MAX_PPS
+#define CH224Q_BUDGET_MAX_PPS 4 //PPS APDOs remembered per port, further ones are ignored
+#endif
+
+
+struct CH224Q_PortContract {
+    uint8_t mode = CH224Q_MODE_UNKNOWN; // CH224Q_MODE_xxx, CH224Q_MODE_UNKNOWN if not negotiated (yet)
+    uint16_t voltage_mV = 0;
+    uint16_t current_mA = 0;            // granted current: demand limited to what the contract offers
+    uint32_t power_mW = 0;              // power reserved from the budget for this port
+};
+
+
+class CH224Q_PowerBudget {
+public:
+
+    CH224Q_PowerBudget(uint32_t totalBudget_mW); //Constructor
+
+    /**
+     * Adds an already initialised (begin()) CH224Q and reads its source capabilities.
+     * Returns the port index used by the other calls, -1 if CH224Q_BUDGET_MAX_PORTS is reached.
+     * A new port has no demand until setDemand() is called.
+     **/
+    int8_t addPort(CH224Q* ch, uint8_t priority);
+    int8_t refreshPort(uint8_t port); //re-reads the source capabilities of a port, e.g. after the PSU was replaced
+
+    void setTotalBudget_mW(uint32_t totalBudget_mW);
+    int8_t setPriority(uint8_t port, uint8_t priority); //higher value is served first
+    int8_t setDemand(uint8_t port, uint16_t voltage_mV, uint16_t current_mA); //voltage_mV = 0: port idles at 5V without demand
+
+    /**
+     * Plans the contracts for the current demands and applies the ones which changed.
+     * Returns 0 on success, -1 if a port failed to negotiate (it is retried on the next call,
+     * if it was being lowered no port is raised) and -2 if the budget doesn't even cover all ports at 5V
+     * (contracts are applied anyway).
+     **/
+    int8_t rebalance();
+
+    const CH224Q_PortContract* getContract(uint8_t port); //contract currently applied, nullptr for an invalid port
+    uint32_t getAllocated_mW(); //sum of the power reserved by all applied contracts
+    uint8_t getRenegotiations(); //number of ports renegotiated by the last rebalance()
+
+private:
+
+    struct PPSRange {
+        uint16_t min_mV;
+        uint16_t max_mV;
+        uint16_t current_mA;
+    };
+
+    struct Port {
+        CH224Q* ch = nullptr;
+        uint8_t priority = 0;
+        uint16_t demandVoltage_mV = 0;
+        uint16_t demandCurrent_mA = 0;
+        uint16_t fixedCurrent_mA[6] = {0}; // max current of the fixed PDOs, indexed by CH224Q_MODE_5V..CH224Q_MODE_28V, 0 if not offered
+        PPSRange pps[CH224Q_BUDGET_MAX_PPS];
+        uint8_t numPPS = 0;
+        CH224Q_PortContract applied;
+        uint16_t previousCurrent_mA = 0;   // current register before the last renegotiation
+        bool currentPending = false;       // current register may still show the previous contract
+    };
+
+    bool planContract(const Port& p, uint16_t voltage_mV, CH224Q_PortContract& c);
+    int8_t applyContract(Port& p, const CH224Q_PortContract& c);
+    void limitToContract(Port& p);
+
+    Port ports[CH224Q_BUDGET_MAX_PORTS];
+    uint8_t numPorts = 0;
+    uint32_t budget_mW;
+    uint8_t renegotiations = 0;
+
+};
+
+#endif // CH224Q_ENABLE_DECODER
@@ -0,0 +1,193 @@
+#include "CH224Q_Protocol.h"
+
+//parser states
+#define RX_WAIT_SOF     0
+#define RX_LEN          1
+#define RX_CMD          2
+#define RX_PAYLOAD      3
+#define RX_CRC          4
+
+
+static void putU16(uint8_t* buf, uint16_t v)
+{
+    buf[0] = v & 0xFF;
+    buf[1] = (v >> 8) & 0xFF;
+}
+
+static void putU32(uint8_t* buf, uint32_t v)
+{
+    for (uint8_t i = 0; i < 4; i++)
+        buf[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint16_t getU16(const uint8_t* buf)
+{
+    return (uint16_t)buf[0] | ((uint16_t)buf[1] << 8);
+}
+
+
+CH224Q_Protocol::CH224Q_Protocol(CH224Q* _ch, Stream* _stream)
+{
+    ch = _ch;
+    stream = _stream;
+}
+
+void CH224Q_Protocol::poll()
+{
+    if (!ch || !stream) return;
+
+    //drop a half received frame if the host stopped sending in between
+    if (rxState != RX_WAIT_SOF && (millis() - rxLastByte_ms) > CH224Q_PROTO_RX_TIMEOUT_MS)
+        rxState = RX_WAIT_SOF;
+
+    while (stream->available() > 0) {
+        int b = stream->read();
+        if (b < 0)
+            break;
+        rxLastByte_ms = millis();
+        handleByte((uint8_t)b);
+    }
+
+    if (telemetryPeriod_ms != 0 && (millis() - lastTelemetry_ms) >= telemetryPeriod_ms) {
+        lastTelemetry_ms = millis();
+        sendTelemetry();
+    }
+}
+
+void CH224Q_Protocol::handleByte(uint8_t b)
+{
+    switch (rxState) {
+        case RX_WAIT_SOF:
+            if (b == CH224Q_PROTO_SOF)
+                rxState = RX_LEN;
+            break;
+
+        case RX_LEN:
+            if (b > CH224Q_PROTO_MAX_PAYLOAD) {
+                rxState = RX_WAIT_SOF; //can't be a valid frame, resync on next SOF
+                break;
+            }
+            rxLen = b;
+            rxCrc = CH224Q_crc8(0, b);
+            rxState = RX_CMD;
+            break;
+
+        case RX_CMD:
+            rxCmd = b;
+            rxCrc = CH224Q_crc8(rxCrc, b);
+            rxPos = 0;
+            rxState = (rxLen > 0) ? RX_PAYLOAD : RX_CRC;
+            break;
+
+        case RX_PAYLOAD:
+            rxBuf[rxPos++] = b;
+            rxCrc = CH224Q_crc8(rxCrc, b);
+            if (rxPos >= rxLen)
+                rxState = RX_CRC;
+            break;
+
+        case RX_CRC:
+            rxState = RX_WAIT_SOF;
+            if (b != rxCrc) {
+#ifdef CH224Q_DEBUG
+                Serial.println("[CH224Q|Info] CH224Q_Protocol: dropped frame with bad CRC");
+#endif
+                break; //no reply, host will time out and retry
+            }
+            dispatch();
+            break;
+
+        default:
+            rxState = RX_WAIT_SOF;
+            break;
+    }
+}
+
+void CH224Q_Protocol::dispatch()
+{
+    uint8_t reply[CH224Q_PROTO_MAX_PAYLOAD];
+    uint8_t len = 1; //result byte is always present
+    int8_t result = 0;
+
+    switch (rxCmd) {
+        case CH224Q_CMD_PING:
+            reply[len++] = CH224Q_PROTO_VERSION;
+            break;
+
+        case CH224Q_CMD_GET_CAPS: {
+            int8_t count = ch->getNumberPDOs();
+            if (count > 12) count = 12; //CH224Q can handle up to 12 PDOs
+            reply[len++] = count;
+            for (uint8_t i = 0; i < count; i++) {
+                putU32(&reply[len], ch->getPDORawValue(i));
+                len += 4;
+            }
+            break;
+        }
+
+        case CH224Q_CMD_GET_STATUS:
+            reply[len++] = ch->getStatus();
+            reply[len++] = ch->getMode();
+            break;
+
+        case CH224Q_CMD_GET_CURRENT:
+            putU16(&reply[len], ch->getMaxCurrent_mA());
+            len += 2;
+            break;
+
+        case CH224Q_CMD_SET_MODE:
+            if (rxLen != 1) { result = CH224Q_PROTO_ERR_LENGTH; break; }
+            result = ch->setMode(rxBuf[0]);
+            break;
+
+        case CH224Q_CMD_SET_PPS:
+            if (rxLen != 2) { result = CH224Q_PROTO_ERR_LENGTH; break; }
+            result = ch->requestPPSVoltage_mv(getU16(rxBuf));
+            break;
+
+        case CH224Q_CMD_SET_AVS:
+            if (rxLen != 2) { result = CH224Q_PROTO_ERR_LENGTH; break; }
+            result = ch->requestAVSVoltage_mv(getU16(rxBuf));
+            break;
+
+        case CH224Q_CMD_STREAM:
+            if (rxLen != 2) { result = CH224Q_PROTO_ERR_LENGTH; break; }
+            telemetryPeriod_ms = getU16(rxBuf);
+            lastTelemetry_ms = millis() - telemetryPeriod_ms; //first telemetry frame goes out on the next poll()
+            break;
+
+        default:
+            result = CH224Q_PROTO_ERR_UNKNOWN_CMD;
+            break;
+    }
+
+    reply[0] = (uint8_t)result;
+    sendFrame(rxCmd | CH224Q_PROTO_REPLY, reply, len);
+}
+
+void CH224Q_Protocol::sendFrame(uint8_t cmd, const uint8_t* payload, uint8_t len)
+{
+    uint8_t header[3] = {CH224Q_PROTO_SOF, len, cmd};
+
+    uint8_t crc = CH224Q_crc8(0, len);
+    crc = CH224Q_crc8(crc, cmd);
+    for (uint8_t i = 0; i < len; i++)
+        crc = CH224Q_crc8(crc, payload[i]);
+
+    stream->write(header, 3);
+    if (len > 0)
+        stream->write(payload, len);
+    stream->write(crc);
+}
+
+void CH224Q_Protocol::sendTelemetry()
+{
+    uint8_t payload[8];
+
+    putU32(&payload[0], millis());
+    payload[4] = ch->getStatus();
+    payload[5] = ch->getMode();
+    putU16(&payload[6], ch->getMaxCurrent_mA());
+
+    sendFrame(CH224Q_CMD_TELEMETRY, payload, sizeof(payload));
+}
@@ -0,0 +1,49 @@
+/*
+    CH224Q_Protocol.h - Device side dispatcher for the compact binary command/telemetry protocol
+    Reads framed commands from any Stream (Serial, USB-CDC, ...), executes them on a CH224Q instance
+    and answers with framed replies. Optionally streams telemetry frames at a fixed period.
+    Frame layout and command codes: see CH224Q_Protocol_Defs.h, host controller: extras/host/ch224q_ctl.cpp
+    License: MIT 4R3N(cad435) 2025-12-13
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "CH224Q_Arduino.h"
+#include "CH224Q_Protocol_Defs.h"
+
+
+class CH224Q_Protocol {
+public:
+
+    CH224Q_Protocol(CH224Q* _ch, Stream* _stream); //Constructor
+
+    /**
+     * Call this as often as possible from loop().
+     * Parses all bytes available on the stream, executes complete frames and sends due telemetry.
+     * Commands which change the mode block for as long as the corresponding CH224Q call does.
+     **/
+    void poll();
+
+private:
+
+    void handleByte(uint8_t b);
+    void dispatch();
+    void sendFrame(uint8_t cmd, const uint8_t* payload, uint8_t len);
+    void sendTelemetry();
+
+    CH224Q* ch;
+    Stream* stream;
+
+    uint8_t rxState = 0; //parser state, see CH224Q_Protocol.cpp
+    uint8_t rxLen = 0;
+    uint8_t rxCmd = 0;
+    uint8_t rxPos = 0;
+    uint8_t rxCrc = 0;
+    uint8_t rxBuf[CH224Q_PROTO_MAX_PAYLOAD];
+    uint32_t rxLastByte_ms = 0;
+
+    uint16_t telemetryPeriod_ms = 0; //0 = telemetry stream off
+    uint32_t lastTelemetry_ms = 0;
+
+};
@@ -0,0 +1,56 @@
+/*
+ * CH224Q_Protocol_Defs.h
+ * Frame layout and command codes of the compact binary command/telemetry protocol.
+ * This header has no Arduino dependency so the host tools (extras/host) can include it as well.
+ *
+ * Frame: [SOF][LEN][CMD][PAYLOAD (LEN bytes)][CRC8]
+ *  - SOF is always CH224Q_PROTO_SOF
+ *  - LEN is the payload length only (0..CH224Q_PROTO_MAX_PAYLOAD)
+ *  - CRC8 (poly 0x07, init 0x00) is calculated over LEN, CMD and PAYLOAD
+ *  - all multi-byte values are little endian (same byte order as the PDO registers)
+ *
+ * Replies use the request command code with CH224Q_PROTO_REPLY set. The first payload byte
+ * of every reply is the int8_t result of the library call (0 = success, same codes as the library).
+ *
+ * License: MIT 4R3N(cad435) 2025-12-13
+ */
+
+#ifndef CH224Q_PROTOCOL_DEFS_H
+#define CH224Q_PROTOCOL_DEFS_H
+
+#include <stdint.h>
+
+#define CH224Q_PROTO_VERSION            0x01
+#define CH224Q_PROTO_SOF                0xA5
+#define CH224Q_PROTO_MAX_PAYLOAD        64    //largest reply is GET_CAPS: result + count + 12 PDOs * 4 bytes = 50 bytes
+#define CH224Q_PROTO_FRAME_OVERHEAD     4     //SOF + LEN + CMD + CRC
+#define CH224Q_PROTO_RX_TIMEOUT_MS      50    //a partially received frame is dropped after this gap between two bytes
+
+#define CH224Q_PROTO_REPLY              0x80  //set in CMD of every reply frame
+
+//commands (host -> device), payload in brackets
+#define CH224Q_CMD_PING                 0x01  //[] -> [result][protocol version]
+#define CH224Q_CMD_GET_CAPS             0x02  //[] -> [result][count][count * raw PDO u32]
+#define CH224Q_CMD_GET_STATUS           0x03  //[] -> [result][status][mode]
+#define CH224Q_CMD_GET_CURRENT          0x04  //[] -> [result][max current mA u16]
+#define CH224Q_CMD_SET_MODE             0x10  //[mode] -> [result]
+#define CH224Q_CMD_SET_PPS              0x11  //[voltage mV u16] -> [result]
+#define CH224Q_CMD_SET_AVS              0x12  //[voltage mV u16] -> [result]
+#define CH224Q_CMD_STREAM               0x20  //[period ms u16, 0 = off] -> [result]
+
+//unsolicited frames (device -> host)
+#define CH224Q_CMD_TELEMETRY            0x40  //reply bit not set, never collides with a reply. [millis u32][status][mode][max current mA u16]
+
+//protocol level result codes, library results are passed through unchanged
+#define CH224Q_PROTO_ERR_UNKNOWN_CMD    (-10)
+#define CH224Q_PROTO_ERR_LENGTH         (-11)
+
+static inline uint8_t CH224Q_crc8(uint8_t crc, uint8_t data)
+{
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; i++)
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    return crc;
+}
+
+#endif // CH224Q_PROTOCOL_DEFS_H
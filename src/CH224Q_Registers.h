@@ -8,6 +8,12 @@
 #define CH224Q_AVX_CTRL2                0x52  //AVX_CTRL2 contains the lower 8 Bits, AVX_CTRL1 the upper 7 Bits plus a enable Bit (hightest bit)
 #define CH224Q_PPS_VOLTAGE_CTRL         0x53  //Contains the desired PPS Voltage in 100mV per LSB when in PPS-Mode | Write-Only
 
+#define CH224Q_PPS_LSB_MV               100   //resolution of CH224Q_PPS_VOLTAGE_CTRL (8 Bits)
+#define CH224Q_AVS_LSB_MV               100   //resolution of CH224Q_AVX_CTRL1/2 (15 Bits)
+#define CH224Q_AVX_ENABLE               0x80  //enable Bit in CH224Q_AVX_CTRL1
+#define CH224Q_AVS_MIN_MV               9000  //lowest voltage of any AVS APDO (SPR AVS)
+#define CH224Q_AVS_MAX_MV               28000 //highest voltage the CH224Q negotiates (EPR AVS)
+
 #define CH224Q_SRCCAP_META              0x60  //Contains the Source Capabilities as sent by the Power-Source. There are registers 0x60 to 0x8F per datasheet. The first 2 registers however are not used for the actual data
                                               //Most likely Metadata is stored there.
 #define CH224Q_SRCCAP_START             0x62  //Contains the Source Capabilities as sent by the Power-Source. Datasheet does not specify what registers 0x60 & 0x61 are holding, but this does not contain valid PDO Data